@@ -22,6 +22,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
+#include <stddef.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -156,6 +157,39 @@ void updatePredictor(uint64_t seq_no,		// dynamic micro-instruction #
 		     uint64_t actual_value,	// value of destination register (0xdeadbeef if instr. is not eligible for value prediction)
 		     uint64_t actual_latency);	// actual execution latency of instruction
 
+//
+// updatePredictorBatch()    [optional]
+//
+// If the contestant defines this function, the simulator calls it instead of updatePredictor(), once for
+// each group of micro-instructions that retire in the same cycle, in retirement order ("retired[0]" is the oldest).
+// Each RetireInfo holds the arguments updatePredictor() would have received. The ordering guarantees of
+// updatePredictor() still hold: all micro-instructions that retire before the next getPrediction() are delivered
+// before it. Delivering a cycle's worth of retirements in one call lets the predictor amortize its table updates.
+//
+// Contestants who do not define it get a default (in the simulator library) that calls updatePredictor() for each
+// micro-instruction, in order.
+//
+struct RetireInfo
+{
+	uint64_t seq_no;		// dynamic micro-instruction #
+	uint64_t actual_addr;		// load or store address (0xdeadbeef if not a load or store instruction)
+	uint64_t actual_value;		// value of destination register (0xdeadbeef if instr. is not eligible for value prediction)
+	uint64_t actual_latency;	// actual execution latency of instruction
+};
+
+extern
+void updatePredictorBatch(const RetireInfo *retired, size_t n);
+
+//
+// predictorFootprint()
+//
+// Optional: host memory used by the contestant's predictor, in bytes. It is reported in the simulator's
+// memory footprint section and counted against the memory budget (-G). The default (in the simulator
+// library) returns 0, meaning unknown.
+//
+extern
+uint64_t predictorFootprint();
+
 //
 // beginPredictor()
 // 
@@ -0,0 +1,160 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include <mutex>
+#include <vector>
+#include "parameters.h"
+#include "arena.h"
+
+struct arena_region_t {
+   uint8_t *next;	// first free byte of the current chunk
+   uint8_t *end;
+};
+
+struct arena_block_t {
+   uint8_t *p;
+   uint64_t bytes;
+};
+
+static arena_region_t regions[ARENA_NUM_HEATS];
+static std::vector<arena_block_t> free_blocks[ARENA_NUM_HEATS];	// freed tables, reused by tables of the same size
+static arena_stats_t stats;
+static std::mutex arena_lock;	// cores of a multi-core simulation are built on their own threads
+
+static const char *arena_heat_names[ARENA_NUM_HEATS] = {"hot", "warm", "cold"};
+
+// Map a chunk of at least "size" bytes (rounded up to whole huge pages), aligned to ARENA_PAGE.
+static uint8_t *arena_map(uint64_t &size) {
+   size = (((size + ARENA_PAGE - 1) / ARENA_PAGE) * ARENA_PAGE);
+   stats.mapped += size;
+   stats.chunks++;
+
+#ifdef MAP_HUGETLB
+   // Reserved huge pages: the mapping fails up front if too few are free.
+   if (HUGE_PAGES) {
+      void *p = mmap(NULL, size, (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+      if (p != MAP_FAILED) {
+         stats.hugetlb_chunks++;
+         return((uint8_t *)p);
+      }
+   }
+#endif
+
+   // Default pages: over-map by a huge page, trim to an aligned chunk, then ask for THP.
+   void *p = mmap(NULL, (size + ARENA_PAGE), (PROT_READ | PROT_WRITE), (MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE), -1, 0);
+   if (p == MAP_FAILED) {
+      fprintf(stderr, "Could not map %lu bytes for the table arena.\n", size);
+      exit(1);
+   }
+   uintptr_t base = (uintptr_t)p;
+   uintptr_t aligned = ((base + ARENA_PAGE - 1) & ~((uintptr_t)ARENA_PAGE - 1));
+   if (aligned > base)
+      munmap(p, (aligned - base));
+   if ((base + size + ARENA_PAGE) > (aligned + size))
+      munmap((void *)(aligned + size), ((base + size + ARENA_PAGE) - (aligned + size)));
+#ifdef MADV_HUGEPAGE
+   madvise((void *)aligned, size, (HUGE_PAGES ? MADV_HUGEPAGE : MADV_NOHUGEPAGE));
+#endif
+   return((uint8_t *)aligned);
+}
+
+void *arena_alloc(uint64_t bytes, arena_heat_t heat, uint64_t align) {
+   assert((heat < ARENA_NUM_HEATS) && align && !(align & (align - 1)) && (align <= ARENA_PAGE));
+   std::lock_guard<std::mutex> guard(arena_lock);
+   arena_region_t &r = regions[heat];
+
+   std::vector<arena_block_t> &f = free_blocks[heat];
+   for (uint64_t i = 0; i < f.size(); i++) {
+      if ((f[i].bytes == bytes) && !((uintptr_t)f[i].p & (align - 1))) {
+         uint8_t *p = f[i].p;
+         f[i] = f.back();
+         f.pop_back();
+         memset(p, 0, bytes);
+         stats.bytes[heat] += bytes;
+         return(p);
+      }
+   }
+
+   uint8_t *p = (uint8_t *)(((uintptr_t)r.next + align - 1) & ~((uintptr_t)align - 1));
+   if (!r.next || ((uint64_t)(r.end - p) < bytes)) {
+      // The rest of the current chunk is abandoned: tables are few and large.
+      uint64_t size = ((bytes > ARENA_CHUNK) ? bytes : ARENA_CHUNK);
+      p = arena_map(size);
+      r.end = (p + size);
+   }
+   r.next = (p + bytes);
+   stats.bytes[heat] += bytes;
+   return(p);
+}
+
+void arena_free(void *p, uint64_t bytes, arena_heat_t heat) {
+   assert(heat < ARENA_NUM_HEATS);
+   if (!p)
+      return;
+   std::lock_guard<std::mutex> guard(arena_lock);
+   free_blocks[heat].push_back({(uint8_t *)p, bytes});
+   stats.bytes[heat] -= bytes;
+}
+
+arena_stats_t arena_stats() {
+   std::lock_guard<std::mutex> guard(arena_lock);
+   return(stats);
+}
+
+// Anonymous memory of this process backed by transparent huge pages, in KB (0 if unknown).
+static uint64_t anon_huge_kb() {
+   FILE *fp = fopen("/proc/self/smaps_rollup", "r");
+   if (!fp)
+      return(0);
+   char line[256];
+   uint64_t kb = 0;
+   while (fgets(line, sizeof(line), fp)) {
+      if (sscanf(line, "AnonHugePages: %lu kB", &kb) == 1)
+         break;
+   }
+   fclose(fp);
+   return(kb);
+}
+
+void arena_output() {
+   arena_stats_t s = arena_stats();
+   printf("Table arena: %lu chunks, %.2f MB mapped (", s.chunks, ((double)s.mapped / (double)(1 << 20)));
+   for (int h = 0; h < ARENA_NUM_HEATS; h++)
+      printf("%s%s %.2f MB", (h ? ", " : ""), arena_heat_names[h], ((double)s.bytes[h] / (double)(1 << 20)));
+   printf(" allocated)\n");
+   if (!HUGE_PAGES)
+      printf("Table arena pages: default size (-X)\n");
+   else if (s.hugetlb_chunks == s.chunks)
+      printf("Table arena pages: 2 MB, reserved (MAP_HUGETLB)\n");
+   else
+      printf("Table arena pages: 2 MB, transparent (%lu of %lu chunks reserved); process AnonHugePages = %lu kB\n",
+             s.hugetlb_chunks, s.chunks, anon_huge_kb());
+}
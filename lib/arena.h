@@ -0,0 +1,94 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <inttypes.h>
+#include <new>
+
+// Huge-page arena for the large simulator and predictor tables.
+//
+// The cache tag stores, the TAGE-SC-L and ITTAGE tables and the value predictor's tables
+// are looked up on almost every simulated instruction, at scattered indices. Spread over
+// separate 4KB-page allocations, they keep the host's DTLB missing. The arena serves them
+// from a few 2MB-aligned chunks backed by 2MB pages: reserved huge pages (MAP_HUGETLB)
+// when the host has some, otherwise transparent huge pages (madvise(MADV_HUGEPAGE)).
+//
+// Tables are grouped by how often they are accessed: each heat class fills its own chunks,
+// so the tables touched on every instruction share as few pages (and TLB entries) as
+// possible, and rarely touched ones do not dilute them. Arena memory is zeroed. It is never
+// unmapped: a table that is freed (its simulator is deleted, e.g., after probing the memory
+// budget or simulating a trace alone) is kept for the next table of the same size and heat,
+// so building the same simulator again takes no more memory.
+//
+// With -X (HUGE_PAGES off), chunks are placed the same way but use the default page size,
+// for comparison. The instrumentation build (make PROFILE=1) reports the host's DTLB misses.
+
+#define ARENA_PAGE	(1 << 21)	// huge page size
+#define ARENA_CHUNK	(1 << 22)	// smallest chunk mapped at once
+
+enum arena_heat_t {
+   ARENA_HOT = 0,	// touched on most instructions: branch and value predictors, I$ and L1$ tags
+   ARENA_WARM,		// touched on L1$ misses: L2$ tags
+   ARENA_COLD,		// touched on L2$ misses: L3$ tags
+   ARENA_NUM_HEATS
+};
+
+struct arena_stats_t {
+   uint64_t bytes[ARENA_NUM_HEATS];	// allocated, per heat class
+   uint64_t mapped;			// bytes of all chunks
+   uint64_t chunks;
+   uint64_t hugetlb_chunks;		// chunks backed by reserved huge pages
+};
+
+// "bytes" of zeroed memory aligned to "align" (a power of 2, at most ARENA_PAGE).
+void *arena_alloc(uint64_t bytes, arena_heat_t heat, uint64_t align = 64);
+
+// Give back "p", from arena_alloc() with the same "bytes" and "heat".
+void arena_free(void *p, uint64_t bytes, arena_heat_t heat);
+
+// An array of "n" default-constructed T.
+template <class T>
+T *arena_new(uint64_t n, arena_heat_t heat) {
+   T *p = (T *)arena_alloc((n * sizeof(T)), heat, alignof(T));
+   for (uint64_t i = 0; i < n; i++)
+      new (p + i) T();
+   return(p);
+}
+
+// Destroy and give back an array from arena_new().
+template <class T>
+void arena_delete(T *p, uint64_t n, arena_heat_t heat) {
+   for (uint64_t i = 0; i < n; i++)
+      p[i].~T();
+   arena_free(p, (n * sizeof(T)), heat);
+}
+
+arena_stats_t arena_stats();
+
+// Print the arena's usage and how much of the process is backed by transparent huge pages.
+void arena_output();
+
+#endif
@@ -33,13 +33,25 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 bp_t::bp_t(uint64_t cb_pc_length, uint64_t cb_bhr_length,
 	   uint64_t ib_pc_length, uint64_t ib_bhr_length,
-	   uint64_t ras_size)
+	   uint64_t ras_size, bool tables)
    /* A. Seznec: introduction of  TAGE-SC-L and ITTAGE*/
-   : TAGESCL(new PREDICTOR())
-   , ITTAGE(new IPREDICTOR())
-   , ras(ras_size) {
+   : TAGESCL(tables ? new (arena_alloc(sizeof(PREDICTOR), ARENA_HOT, alignof(PREDICTOR))) PREDICTOR() : (PREDICTOR *)NULL)
+   , ITTAGE(tables ? new (arena_alloc(sizeof(IPREDICTOR), ARENA_HOT, alignof(IPREDICTOR))) IPREDICTOR() : (IPREDICTOR *)NULL)
+   , ras(ras_size)
+   , perfect_pcs((const pc_ranges_t *)NULL) {
 
    // Initialize measurements.
+   reset_stats();
+}
+
+bp_t::~bp_t() {
+   if (TAGESCL)
+      arena_delete(TAGESCL, 1, ARENA_HOT);
+   if (ITTAGE)
+      arena_delete(ITTAGE, 1, ARENA_HOT);
+}
+
+void bp_t::reset_stats() {
    meas_branch_n = 0;
    meas_branch_m = 0;
    meas_jumpdir_n = 0;
@@ -51,17 +63,36 @@ bp_t::bp_t(uint64_t cb_pc_length, uint64_t cb_bhr_length,
    meas_notctrl_m = 0;
 }
 
-bp_t::~bp_t() {
+bp_stats_t bp_t::get_stats() const {
+   return {meas_branch_n, meas_branch_m,
+           meas_jumpdir_n,
+           meas_jumpind_n, meas_jumpind_m,
+           meas_jumpret_n, meas_jumpret_m,
+           meas_notctrl_n, meas_notctrl_m};
+}
+
+void bp_t::add_stats(const bp_stats_t &s) {
+   meas_branch_n += s.branch_n;
+   meas_branch_m += s.branch_m;
+   meas_jumpdir_n += s.jumpdir_n;
+   meas_jumpind_n += s.jumpind_n;
+   meas_jumpind_m += s.jumpind_m;
+   meas_jumpret_n += s.jumpret_n;
+   meas_jumpret_m += s.jumpret_m;
+   meas_notctrl_n += s.notctrl_n;
+   meas_notctrl_m += s.notctrl_m;
 }
 
-// Returns true if instruction is a mispredicted branch.
-// Also updates all branch predictor structures as applicable.
-bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
+// Returns true if the control-transfer instruction is mispredicted (oracle overrides are applied by the caller).
+// Also updates all branch predictor structures as applicable (not the measurements).
+bool bp_t::train_control(InstClass insn, uint64_t pc, uint64_t next_pc) {
    bool taken;
    bool pred_taken;
    uint64_t pred_target;
    bool misp;
 
+   assert(TAGESCL && ITTAGE);
+
    if (insn == InstClass::condBranchInstClass) {
       // CONDITIONAL BRANCH
 
@@ -76,9 +107,6 @@ bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
       
       /* A. Seznec: uodate TAGE-SC-L*/
       TAGESCL-> UpdatePredictor (pc , 1,  taken, pred_taken, next_pc);
-      // Update measurements.
-      meas_branch_n++;
-      meas_branch_m += misp;
    }
    else if (insn == InstClass::uncondDirectBranchInstClass) {
       // CALL OR JUMP DIRECT
@@ -98,9 +126,6 @@ bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
       if (is_link_reg(insn.rd()))
          ras.push(pc + 4);
 #endif
-
-      // Update measurements.
-      meas_jumpdir_n++;
    }
    else if (insn == InstClass::uncondIndirectBranchInstClass) {
 #if 0
@@ -123,8 +148,6 @@ bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
 #endif
       if (PERFECT_INDIRECT_PRED) {
 	      misp = false;
-         // Update measurements.
-         meas_jumpind_n++;
       }
       else {
          // Make prediction.
@@ -135,10 +158,6 @@ bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
       
          /* A. Seznec: update ITTAGE*/
          ITTAGE-> UpdatePredictor (pc , next_pc);
-      
-         // Update measurements.
-         meas_jumpind_n++;
-         meas_jumpind_m += misp;
       }
 
       /* A. Seznec: update history for TAGE-SC-L */
@@ -152,12 +171,8 @@ bool bp_t::predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
 #endif
    }
    else {
-      // not a control-transfer instruction
-      misp = (next_pc != pc + 4);
-
-      // Update measurements.
-      meas_notctrl_n++;
-      meas_notctrl_m+=misp;
+      assert(0);	// not a control-transfer instruction: see train()
+      misp = false;
    }
 
    return(misp);
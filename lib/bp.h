@@ -22,8 +22,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 // Modified by A. Seznec (andre.seznec@inria.fr) to include TAGE-SC-L predictor and the ITTAGE indirect branch predictor
 
+#include "arena.h"
 #include "tage_sc_l.h"
 #include "ittage.h"
+#include "oracle.h"
 
 class ras_t {
 private:
@@ -52,6 +54,17 @@ public:
 	   tos = ((tos > 0) ? (tos - 1) : (size - 1));
 	   return(ras[tos]);
 	}
+
+	uint64_t footprint() const { return(size * sizeof(uint64_t)); }
+};
+
+// Measurements of the branch predictor, for combining the results of separately simulated regions.
+struct bp_stats_t {
+	uint64_t branch_n, branch_m;
+	uint64_t jumpdir_n;
+	uint64_t jumpind_n, jumpind_m;
+	uint64_t jumpret_n, jumpret_m;
+	uint64_t notctrl_n, notctrl_m;
 };
 
 class bp_t {
@@ -65,9 +78,16 @@ private:
 	// Return address stack for predicting return targets.
 	ras_t ras;
 
+	// Branches that are predicted perfectly (oracle overrides; NULL if none).
+	const pc_ranges_t *perfect_pcs;
+	inline bool is_perfect_pc(uint64_t pc) const { return(perfect_pcs && perfect_pcs->contains(pc)); }
+
 	// Check for link register (x1) or alternate link register (x5)
 	bool is_link_reg(uint64_t x);
 
+	// Prediction of control-transfer instructions (before oracle overrides).
+	bool train_control(InstClass insn, uint64_t pc, uint64_t next_pc);
+
 	// Measurements.
 	uint64_t meas_branch_n;		// # branches
 	uint64_t meas_branch_m;		// # mispredicted branches
@@ -80,14 +100,84 @@ private:
 	uint64_t meas_notctrl_m;	// # non-control transfer instructions for which: next_pc != pc + 4
 
 public:
+	// Without "tables", the predictors are not instantiated: outcomes must come from elsewhere
+	// (see bp_sidecar.h), and only measure() and override() may be used.
 	bp_t(uint64_t cb_pc_length, uint64_t cb_bhr_length,
 	     uint64_t ib_pc_length, uint64_t ib_bhr_length,
-	     uint64_t ras_size);
+	     uint64_t ras_size, bool tables = true);
+	bp_t(const bp_t &) = delete;	// owns its predictors
+	bp_t &operator=(const bp_t &) = delete;
 	~bp_t();
 
 	// Returns true if instruction is a mispredicted branch.
-	// Also updates all branch predictor structures as applicable.
-	bool predict(InstClass insn, uint64_t pc, uint64_t next_pc);
+	// Also updates all branch predictor structures and measurements as applicable.
+	inline bool predict(InstClass insn, uint64_t pc, uint64_t next_pc) {
+	   bool misp = train(insn, pc, next_pc);
+	   measure(insn, misp);
+	   return(misp);
+	}
+
+	// The two halves of predict(). train() depends only on the instruction stream, so it can
+	// run ahead of the timing model on another thread (see bp_ahead.h), while the simulation
+	// thread calls measure() in program order.
+	inline bool train(InstClass insn, uint64_t pc, uint64_t next_pc) {
+	   return(override(insn, pc, train_raw(insn, pc, next_pc)));
+	}
+
+	// Outcome of the predictors alone, before oracle overrides: this is what a branch outcome
+	// sidecar records, so one sidecar serves any oracle file.
+	// Most instructions are not control transfers: they are handled inline.
+	inline bool train_raw(InstClass insn, uint64_t pc, uint64_t next_pc) {
+	   if (!is_control(insn))
+	      return(next_pc != pc + 4);	// not a control-transfer instruction
+	   return(train_control(insn, pc, next_pc));
+	}
+
+	// Apply oracle overrides to a raw outcome.
+	inline bool override(InstClass insn, uint64_t pc, bool misp) const {
+	   return(misp && !(is_control(insn) && is_perfect_pc(pc)));
+	}
+
+	static inline bool is_control(InstClass insn) {
+	   return((insn == InstClass::condBranchInstClass) ||
+	          (insn == InstClass::uncondDirectBranchInstClass) ||
+	          (insn == InstClass::uncondIndirectBranchInstClass));
+	}
+
+	inline void measure(InstClass insn, bool misp) {
+	   if (insn == InstClass::condBranchInstClass) {
+	      meas_branch_n++;
+	      meas_branch_m += misp;
+	   }
+	   else if (insn == InstClass::uncondDirectBranchInstClass) {
+	      meas_jumpdir_n++;		// never mispredicted
+	   }
+	   else if (insn == InstClass::uncondIndirectBranchInstClass) {
+	      meas_jumpind_n++;
+	      meas_jumpind_m += misp;
+	   }
+	   else {
+	      meas_notctrl_n++;
+	      meas_notctrl_m += misp;
+	   }
+	}
+
+	// Predict the branches in "pcs" perfectly. The predictors are still trained on them.
+	void set_perfect_pcs(const pc_ranges_t *pcs) { perfect_pcs = pcs; }
+
+	// Clear all branch prediction measurements (predictor state is kept).
+	void reset_stats();
+
+	// Number of instructions seen and mispredicted, across all types.
+	uint64_t get_num_inst() const { return(meas_branch_n + meas_jumpdir_n + meas_jumpind_n + meas_jumpret_n + meas_notctrl_n); }
+	uint64_t get_num_misp() const { return(meas_branch_m + meas_jumpind_m + meas_jumpret_m + meas_notctrl_m); }
+
+	// Host memory of the predictors (objects and tables), in bytes.
+	uint64_t tage_footprint() const { return(TAGESCL ? TAGESCL->footprint() : 0); }
+	uint64_t ittage_footprint() const { return((ITTAGE ? ITTAGE->footprint() : 0) + ras.footprint()); }
+
+	bp_stats_t get_stats() const;
+	void add_stats(const bp_stats_t &s);
 
 	// Output all branch prediction measurements.
 	void output();
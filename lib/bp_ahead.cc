@@ -0,0 +1,90 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <assert.h>
+#include "cvp.h"
+#include "cvp_trace_reader.h"
+#include "bp.h"
+#include "bp_ahead.h"
+
+bp_ahead_t::bp_ahead_t(CVPTraceReader *reader, bp_t *bp) : head(0), tail(0), stop(false) {
+   this->reader = reader;
+   this->bp = bp;
+   ring = new bp_ahead_entry_t[BP_AHEAD_RING_SIZE];
+   finished = false;
+   predictor = std::thread(&bp_ahead_t::run, this);
+}
+
+bp_ahead_t::~bp_ahead_t() {
+   stop.store(true, std::memory_order_release);
+   predictor.join();
+
+   uint64_t t = tail.load(std::memory_order_acquire);
+   for (uint64_t h = head.load(std::memory_order_relaxed); h != t; h++) {
+      if (ring[h & (BP_AHEAD_RING_SIZE - 1)].inst)
+         delete ring[h & (BP_AHEAD_RING_SIZE - 1)].inst;
+   }
+   delete [] ring;
+}
+
+void bp_ahead_t::run() {
+   while (!stop.load(std::memory_order_acquire)) {
+      db_t *inst = reader->get_inst();
+      bool misp = (inst ? bp->train_raw((InstClass) inst->insn, inst->pc, inst->next_pc) : false);
+
+      uint64_t t = tail.load(std::memory_order_relaxed);
+      while ((t - head.load(std::memory_order_acquire)) == BP_AHEAD_RING_SIZE) {
+         if (stop.load(std::memory_order_acquire)) {	// ring full and the simulation stopped early
+            if (inst)
+               delete inst;
+            return;
+         }
+         std::this_thread::yield();
+      }
+      ring[t & (BP_AHEAD_RING_SIZE - 1)] = {inst, misp};
+      tail.store(t + 1, std::memory_order_release);
+
+      if (!inst)
+         return;	// end of the trace
+   }
+}
+
+db_t *bp_ahead_t::get_inst(bool &misp) {
+   if (finished)
+      return((db_t *)NULL);
+
+   uint64_t h = head.load(std::memory_order_relaxed);
+   while (tail.load(std::memory_order_acquire) == h)
+      std::this_thread::yield();	// ring empty
+
+   bp_ahead_entry_t e = ring[h & (BP_AHEAD_RING_SIZE - 1)];
+   head.store(h + 1, std::memory_order_release);
+
+   finished = (e.inst == NULL);
+   misp = e.misp;
+   return(e.inst);
+}
@@ -0,0 +1,73 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _BP_AHEAD_H_
+#define _BP_AHEAD_H_
+
+#include <atomic>
+#include <thread>
+
+// Decoupled branch prediction: branch prediction depends only on the instruction stream, never
+// on timing, so a separate thread decodes the trace and runs bp_t::train_raw() on each micro-op,
+// ahead of the timing model. Micro-ops and their raw mispredict flags reach the simulation thread
+// through a single-producer/single-consumer ring buffer. The simulation thread still applies
+// oracle overrides and updates the branch prediction measurements (bp_t::measure()) in program
+// order, so warm-up, length limits and early termination see exactly the same counts as inline
+// prediction.
+
+#define BP_AHEAD_RING_SIZE	(1 << 12)	// micro-ops; must be a power of 2
+
+struct db_t;
+struct CVPTraceReader;
+class bp_t;
+
+struct bp_ahead_entry_t {
+   db_t *inst;		// NULL: end of the trace
+   bool misp;		// before oracle overrides
+};
+
+class bp_ahead_t {
+private:
+   CVPTraceReader *reader;
+   bp_t *bp;
+
+   bp_ahead_entry_t *ring;
+   std::atomic<uint64_t> head;	// next micro-op to simulate (consumer)
+   std::atomic<uint64_t> tail;	// next free slot (producer)
+   std::atomic<bool> stop;
+   bool finished;		// the consumer reached the end of the trace
+   std::thread predictor;
+
+   void run();			// prediction thread
+
+public:
+   // "bp" is trained only by the prediction thread from now on.
+   bp_ahead_t(CVPTraceReader *reader, bp_t *bp);
+   ~bp_ahead_t();		// stops the prediction thread and frees the micro-ops it decoded ahead
+
+   // Next micro-op and whether its branch prediction was wrong (before oracle overrides); NULL at the end of the trace.
+   db_t *get_inst(bool &misp);
+};
+
+#endif
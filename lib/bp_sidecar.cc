@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include "bp_sidecar.h"
+#include "parameters.h"
+
+// Identity of a trace file: its size and modification time, and a 64-bit FNV-1a (over 8-byte
+// words) of its first BP_SIDECAR_PREFIX bytes. Validating a sidecar costs one read of a bounded
+// prefix, however large the trace.
+static bool trace_identity(const char *name, bp_sidecar_header_t &h) {
+   struct stat st;
+   if (stat(name, &st) != 0)
+      return(false);
+   h.trace_size = (uint64_t)st.st_size;
+   h.trace_mtime = (((uint64_t)st.st_mtim.tv_sec * 1000000000ull) + (uint64_t)st.st_mtim.tv_nsec);
+
+   FILE *fp = fopen(name, "rb");
+   if (!fp)
+      return(false);
+   uint8_t *buf = new uint8_t[BP_SIDECAR_PREFIX + 8];
+   size_t n = fread(buf, 1, BP_SIDECAR_PREFIX, fp);
+   memset(buf + n, 0, 8);	// pad the last word
+   h.trace_hash = 0xcbf29ce484222325ULL;
+   for (size_t i = 0; i < n; i += 8) {
+      uint64_t w;
+      memcpy(&w, buf + i, 8);
+      h.trace_hash = ((h.trace_hash ^ w) * 0x100000001b3ULL);
+   }
+   delete [] buf;
+   fclose(fp);
+   return(true);
+}
+
+bp_sidecar_t::bp_sidecar_t(const char *filename, const char *trace_name, uint64_t needed) {
+   this->filename = filename;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, BP_SIDECAR_MAGIC, 8);
+   if (!trace_identity(trace_name, header)) {
+      printf("Error: could not read trace %s.\n", trace_name);
+      exit(1);
+   }
+   header.skip = SKIP_INSTS;
+   header.perfect_indirect = (PERFECT_INDIRECT_PRED ? 1 : 0);
+
+   pos = 0;
+   countdown = 0;
+   run = 0;
+   num_uop = 0;
+   loaded = load(needed);
+   if (loaded)
+      countdown = read_gap();
+}
+
+bool bp_sidecar_t::load(uint64_t needed) {
+   FILE *fp = fopen(filename.c_str(), "rb");
+   if (!fp)
+      return(false);
+
+   bp_sidecar_header_t h;
+   bool ok = (fread(&h, sizeof(h), 1, fp) == 1) &&
+             !memcmp(h.magic, header.magic, 8) &&
+             (h.trace_hash == header.trace_hash) && (h.trace_size == header.trace_size) && (h.trace_mtime == header.trace_mtime) &&
+             (h.skip == header.skip) && (h.perfect_indirect == header.perfect_indirect) &&
+             (h.complete || (needed && (h.num_uop >= needed)));
+   if (ok) {
+      gaps.resize(h.num_bytes);
+      ok = ((h.num_bytes == 0) || (fread(&gaps[0], 1, h.num_bytes, fp) == h.num_bytes));
+   }
+   fclose(fp);
+
+   if (!ok) {
+      gaps.clear();
+      return(false);
+   }
+   header = h;
+   return(true);
+}
+
+// Next gap; past the last misprediction, the remaining micro-ops are all predicted correctly.
+uint64_t bp_sidecar_t::read_gap() {
+   uint64_t x = 0;
+   for (unsigned int shift = 0; pos < gaps.size(); shift += 7) {
+      uint8_t b = gaps[pos++];
+      x |= ((uint64_t)(b & 0x7f) << shift);
+      if (!(b & 0x80))
+         return(x);
+   }
+   return(UINT64_MAX);
+}
+
+bool bp_sidecar_t::save(bool complete) {
+   assert(!loaded);
+   header.num_uop = num_uop;
+   header.complete = (complete ? 1 : 0);
+   header.num_bytes = gaps.size();
+
+   FILE *fp = fopen(filename.c_str(), "wb");
+   if (!fp)
+      return(false);
+   bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+             (gaps.empty() || (fwrite(&gaps[0], 1, gaps.size(), fp) == gaps.size()));
+   ok = ((fclose(fp) == 0) && ok);
+   return(ok);
+}
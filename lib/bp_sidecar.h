@@ -0,0 +1,119 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _BP_SIDECAR_H_
+#define _BP_SIDECAR_H_
+
+#include <inttypes.h>
+#include <assert.h>
+#include <string>
+#include <vector>
+
+// Branch outcome sidecar: branch prediction depends only on the trace and the branch predictor
+// configuration, never on timing, so the per-micro-op mispredict outcomes of one run can be
+// reused by later runs that vary anything else (window, caches, lanes, value prediction...).
+// Those runs do not instantiate the predictors at all.
+//
+// The file is a bp_sidecar_header_t (native byte order) followed by the mispredict bitstream,
+// stored as the gaps between mispredicted micro-ops (LEB128 varints) since mispredictions are
+// rare. Outcomes are raw (before oracle overrides), so one sidecar serves any oracle file. The
+// branch prediction measurements are recomputed from the outcomes in program order, so warm-up
+// and length limits apply as usual.
+//
+// A sidecar is used only if its key matches: the trace (size, modification time and a hash of
+// its first BP_SIDECAR_PREFIX bytes), the fast-forward distance at which prediction started,
+// and the branch predictor configuration. Change BP_SIDECAR_MAGIC whenever the predictors change.
+
+#define BP_SIDECAR_MAGIC	"CVPBPSC2"
+#define BP_SIDECAR_PREFIX	(1 << 20)	// bytes of the trace hashed
+
+struct bp_sidecar_header_t {
+   char magic[8];		// BP_SIDECAR_MAGIC
+   uint64_t trace_hash;		// 64-bit FNV-1a of the first BP_SIDECAR_PREFIX bytes of the (compressed) trace file
+   uint64_t trace_size;		// bytes
+   uint64_t trace_mtime;	// modification time (ns)
+   uint64_t skip;		// micro-ops fast-forwarded before prediction started (-S)
+   uint64_t perfect_indirect;	// -i
+   uint64_t num_uop;		// micro-ops covered
+   uint64_t complete;		// 1: covers the rest of the trace
+   uint64_t num_misp;		// mispredicted micro-ops
+   uint64_t num_bytes;		// size of the gap stream that follows
+};
+
+class bp_sidecar_t {
+private:
+   std::string filename;
+   bp_sidecar_header_t header;
+   bool loaded;
+
+   std::vector<uint8_t> gaps;
+   uint64_t pos;		// next byte of "gaps" (loaded)
+   uint64_t countdown;		// correctly predicted micro-ops before the next misprediction (loaded)
+   uint64_t run;		// correctly predicted micro-ops since the last misprediction (recording)
+   uint64_t num_uop;		// micro-ops delivered or recorded so far
+
+   uint64_t read_gap();
+   bool load(uint64_t needed);
+
+public:
+   // Load "filename" if it matches "trace_name" and the current configuration and covers the
+   // first "needed" micro-ops (0: the rest of the trace). Otherwise, prepare to record it.
+   bp_sidecar_t(const char *filename, const char *trace_name, uint64_t needed);
+
+   bool is_loaded() const { return(loaded); }
+
+   // Loaded: outcome of the next micro-op.
+   inline bool next() {
+      assert(loaded && (num_uop < header.num_uop));
+      num_uop++;
+      if (countdown) {
+         countdown--;
+         return(false);
+      }
+      countdown = read_gap();
+      return(true);
+   }
+
+   // Recording: outcome of the next micro-op.
+   inline void record(bool misp) {
+      num_uop++;
+      if (!misp) {
+         run++;
+         return;
+      }
+      for (uint64_t x = run; ; x >>= 7) {
+         gaps.push_back((uint8_t)((x & 0x7f) | ((x >> 7) ? 0x80 : 0)));
+         if (!(x >> 7))
+            break;
+      }
+      header.num_misp++;
+      run = 0;
+   }
+
+   // Recording: write the sidecar. "complete": the end of the trace was reached.
+   bool save(bool complete);
+};
+
+#endif
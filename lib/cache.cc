@@ -26,11 +26,102 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 #include "parameters.h"
 #include "cache.h"
+#include "replacement.h"
+#include "arena.h"
+#include "multicore.h"
 
+const char *repl_policy_names[] = {"lru", "plru", "srrip", "brrip", "random"};
 
-cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t latency, cache_t *next_level) {
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+
+// Way matching: the way of "tags[0 .. assoc-1]" equal to "tag", or "assoc" if none is.
+// Tags within a set are unique, so the first match is the only one. "tags" is line-aligned.
+typedef uint64_t (*match_fn_t)(const uint64_t *tags, uint64_t assoc, uint64_t tag);
+
+static uint64_t match_scalar(const uint64_t *tags, uint64_t assoc, uint64_t tag) {
+   for (uint64_t way = 0; way < assoc; way++)
+      if (tags[way] == tag)
+         return(way);
+   return(assoc);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static uint64_t match_avx2(const uint64_t *tags, uint64_t assoc, uint64_t tag) {
+   __m256i t = _mm256_set1_epi64x((long long)tag);
+   uint64_t way = 0;
+   for (; (way + 4) <= assoc; way += 4) {
+      __m256i eq = _mm256_cmpeq_epi64(_mm256_load_si256((const __m256i *)(tags + way)), t);
+      int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+      if (mask)
+         return(way + __builtin_ctz(mask));
+   }
+   for (; way < assoc; way++)
+      if (tags[way] == tag)
+         return(way);
+   return(assoc);
+}
+
+__attribute__((target("sse4.1")))
+static uint64_t match_sse4(const uint64_t *tags, uint64_t assoc, uint64_t tag) {
+   __m128i t = _mm_set1_epi64x((long long)tag);
+   uint64_t way = 0;
+   for (; (way + 2) <= assoc; way += 2) {
+      __m128i eq = _mm_cmpeq_epi64(_mm_load_si128((const __m128i *)(tags + way)), t);
+      int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+      if (mask)
+         return(way + __builtin_ctz(mask));
+   }
+   if ((way < assoc) && (tags[way] == tag))
+      return(way);
+   return(assoc);
+}
+#endif
+
+// Pick the widest way matcher the host supports, once.
+static match_fn_t select_match() {
+#if defined(__x86_64__) || defined(__i386__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+      return(match_avx2);
+   if (__builtin_cpu_supports("sse4.1"))
+      return(match_sse4);
+#endif
+   return(match_scalar);
+}
+
+static const match_fn_t match = select_match();
+
+// Geometries of the default hierarchy (parameters.cc), specialized with (narrow) LRU replacement.
+typedef cache_geometry_t<6, 8, 8> geometry_ic_t;	// 128KB, 8-way, 64B blocks
+typedef cache_geometry_t<6, 7, 8> geometry_l1_t;	// 64KB, 8-way, 64B blocks
+typedef cache_geometry_t<6, 11, 8> geometry_l2_t;	// 1MB, 8-way, 64B blocks
+typedef cache_geometry_t<7, 12, 16> geometry_l3_t;	// 8MB, 16-way, 128B blocks
+
+enum class CacheGeometries {
+   Runtime = 0,
+   IC,
+   L1,
+   L2,
+   L3
+};
+
+template <class geom_t>
+static bool geometry_is(uint64_t offset_bits, uint64_t index_bits, uint64_t assoc) {
+   return((offset_bits == geom_t::offset_bits) && (index_bits == geom_t::index_bits) && (assoc == geom_t::assoc));
+}
+
+
+cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t latency, cache_t *next_level, uint64_t repl, uint64_t mshrs, uint64_t heat)
+   : mshr_timeline(mshrs ? mshrs : 1), bus_timeline(1) {
    uint64_t num_sets;
 
    assert(IsPow2(blocksize));
@@ -42,102 +133,433 @@ cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t lat
    this->index_mask = (num_sets - 1);
 
    this->assoc = assoc;
+   assert(assoc < (1 << 16));	// the MRU way is 16 bits
+   assert((num_index_bits + num_offset_bits) > 0);	// so that no tag is INVALID_TAG
+
+   this->heat = heat;
+   this->repl = repl;
+   this->wide_lru = ((repl == (uint64_t)ReplPolicies::LRU) && (assoc > repl_lru_t::max_assoc));
+   this->repl_state = ((repl == (uint64_t)ReplPolicies::Random) ? 0x9E3779B97F4A7C15ULL : 0);	// xorshift seed: nonzero
+
+   switch (ReplPolicies(repl)) {
+   case ReplPolicies::LRU:
+      if (wide_lru)
+         init_sets<repl_lru_wide_t>(heat);
+      else
+         init_sets<repl_lru_t>(heat);
+      break;
+   case ReplPolicies::PLRU:
+      init_sets<repl_plru_t>(heat);
+      break;
+   case ReplPolicies::SRRIP:
+      init_sets<repl_srrip_t>(heat);
+      break;
+   case ReplPolicies::BRRIP:
+      init_sets<repl_brrip_t>(heat);
+      break;
+   case ReplPolicies::Random:
+      init_sets<repl_random_t>(heat);
+      break;
+   default:
+      assert(0);
+      break;
+   }
 
-   C = new block_t *[num_sets];
-   for (uint64_t i = 0; i < num_sets; i++) {
-      C[i] = new block_t[assoc];
-      for (uint64_t j = 0; j < assoc; j++) {
-         C[i][j].valid = false;
-	 C[i][j].lru = j;
-      }
+   this->geometry = (uint64_t)CacheGeometries::Runtime;
+   if ((repl == (uint64_t)ReplPolicies::LRU) && !wide_lru) {
+      if (geometry_is<geometry_ic_t>(num_offset_bits, num_index_bits, assoc))
+         this->geometry = (uint64_t)CacheGeometries::IC;
+      else if (geometry_is<geometry_l1_t>(num_offset_bits, num_index_bits, assoc))
+         this->geometry = (uint64_t)CacheGeometries::L1;
+      else if (geometry_is<geometry_l2_t>(num_offset_bits, num_index_bits, assoc))
+         this->geometry = (uint64_t)CacheGeometries::L2;
+      else if (geometry_is<geometry_l3_t>(num_offset_bits, num_index_bits, assoc))
+         this->geometry = (uint64_t)CacheGeometries::L3;
    }
 
    this->latency = latency;
+   this->mshrs = mshrs;
+   this->transfer_cycles = (MAIN_MEMORY_BANDWIDTH ? ((blocksize + MAIN_MEMORY_BANDWIDTH - 1) / MAIN_MEMORY_BANDWIDTH) : 0);
+   this->stamp_base = 0;
    this->next_level = next_level;
+   this->shared_next = (shared_cache_port_t *)NULL;
+   this->replay_timing = (const mem_access_timing_t *)NULL;
+   this->record_timing = (mem_access_timing_t *)NULL;
 
-   accesses = 0;
-   misses = 0;
+   reset_stats();
+}
+
+// Allocate the tag store for "policy_t" and empty every set.
+template <class policy_t>
+void cache_t::init_sets(uint64_t heat) {
+   uint64_t num_sets = (index_mask + 1);
+
+   if ((assoc > policy_t::max_assoc) || ((repl == (uint64_t)ReplPolicies::PLRU) && !IsPow2(assoc))) {
+      fprintf(stderr, "The %s replacement policy does not support %lu-way caches (at most %lu ways%s).\n",
+              repl_policy_names[repl], assoc, policy_t::max_assoc,
+              ((repl == (uint64_t)ReplPolicies::PLRU) ? ", a power of 2" : ""));
+      exit(1);
+   }
+
+   // tags, timestamps, policy metadata, dirty bits and the MRU way, rounded up to whole lines
+   touch_mru_is_noop = policy_t::touch_mru_is_noop;
+   meta_offset = cache_meta_offset(assoc);
+   meta_words = policy_t::words(assoc);
+   set_words = cache_set_words(assoc, meta_words);
+   store = (uint64_t *)arena_alloc((num_sets * set_words * sizeof(uint64_t)), arena_heat_t(heat), CACHE_LINE);
+   for (uint64_t i = 0; i < num_sets; i++) {
+      for (uint64_t j = 0; j < assoc; j++) {
+         tags(i)[j] = INVALID_TAG;
+         stamps(i)[j] = 0;
+      }
+      policy_t::init(meta(i), assoc);
+      for (uint64_t j = 0; j < cache_dirty_words(assoc); j++)
+         dirty(i)[j] = 0;
+      mru(i) = 0;
+   }
 }
 
 cache_t::~cache_t() {
+   arena_free(store, ((index_mask + 1) * set_words * sizeof(uint64_t)), arena_heat_t(heat));
+}
+
+uint64_t cache_t::footprint() const {
+   uint64_t num_sets = (index_mask + 1);
+   return((num_sets * set_words * sizeof(uint64_t)) + mshr_timeline.footprint() + bus_timeline.footprint());
+}
+
+template <class geom_t>
+inline uint64_t cache_t::match_way(const uint64_t *t, uint64_t tag) const {
+   if (!geom_t::assoc)
+      return(match(t, assoc, tag));
+   // Constant associativity: the comparisons unroll into one branch-free mask.
+   uint64_t hits = 0;
+#if defined(__SSE2__)
+   // SSE2 (always present on x86-64) has no 64-bit compare: both 32-bit halves must match.
+   __m128i v = _mm_set1_epi64x((long long)tag);
+   for (uint64_t way = 0; way < geom_t::assoc; way += 2) {
+      __m128i eq = _mm_cmpeq_epi32(_mm_load_si128((const __m128i *)(t + way)), v);
+      eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+      hits |= ((uint64_t)_mm_movemask_pd(_mm_castsi128_pd(eq)) << way);
+   }
+#else
+   for (uint64_t way = 0; way < geom_t::assoc; way++)
+      hits |= ((uint64_t)(t[way] == tag) << way);
+#endif
+   return(hits ? __builtin_ctzll(hits) : geom_t::assoc);
+}
+
+template <class geom_t, class policy_t>
+inline uint64_t cache_t::find(uint64_t index, uint64_t tag) const {
+   const uint64_t *t = tags_of<geom_t, policy_t>(index);
+   uint64_t m = mru_of<geom_t, policy_t>(index);
+   if (t[m] == tag)	// most accesses hit the MRU way
+      return(m);
+   return(match_way<geom_t>(t, tag));
 }
 
 bool cache_t::is_hit(uint64_t cycle, uint64_t addr) const {
-   uint64_t tag = TAG(addr);
+   cache_lookup_t l;
+   return(lookup(addr, l) && is_hit(cycle, l));
+}
+
+template <class geom_t, class policy_t>
+inline bool cache_t::lookup_in(uint64_t addr, cache_lookup_t &l) const {
+   l.valid = true;
+   l.index = index_of<geom_t>(addr);
+   l.tag = tag_of<geom_t>(addr);
+   l.way = find<geom_t, policy_t>(l.index, l.tag);
+   if (l.way == assoc)
+      return false;
+   l.timestamp = from_stamp(stamps_of<geom_t, policy_t>(l.index)[l.way], stamp_base);
+   return true;
+}
+
+bool cache_t::lookup(uint64_t addr, cache_lookup_t &l) const {
+   switch (CacheGeometries(geometry)) {
+   case CacheGeometries::IC:
+      return(lookup_in<geometry_ic_t, repl_lru_t>(addr, l));
+   case CacheGeometries::L1:
+      return(lookup_in<geometry_l1_t, repl_lru_t>(addr, l));
+   case CacheGeometries::L2:
+      return(lookup_in<geometry_l2_t, repl_lru_t>(addr, l));
+   case CacheGeometries::L3:
+      return(lookup_in<geometry_l3_t, repl_lru_t>(addr, l));
+   default:
+      return(lookup_in<cache_geometry_any_t, repl_lru_t>(addr, l));	// any policy: the layout is the runtime one
+   }
+}
+
+uint64_t cache_t::hit_level(uint64_t cycle, uint64_t addr, cache_lookup_t *path) const {
+   lookup(addr, path[0]);
+   if (is_hit(cycle, path[0]))
+      return(1);
+   else if (next_level)
+      return(1 + next_level->hit_level(cycle, addr, path + 1));
+   else if (shared_next)
+      return(shared_next->is_hit(cycle, addr) ? 2 : 3);	// the shared level is not part of the path
+   else
+      return(2);
+}
+
+void cache_t::sync(const cache_t &from) {
+   assert((set_words == from.set_words) && (index_mask == from.index_mask));
+   stamp_base = from.stamp_base;
+   repl_state = from.repl_state;
+   mshr_timeline = from.mshr_timeline;
+   bus_timeline = from.bus_timeline;
+}
+
+void cache_t::copy_set(const cache_t &from, uint64_t addr) {
    uint64_t index = INDEX(addr);
+   memcpy(tags(index), from.tags(index), (set_words * sizeof(uint64_t)));
+}
 
-   for (uint64_t way = 0; way < assoc; way++) {
-      if (C[index][way].valid && (C[index][way].tag == tag)) {
-         auto avail = ((C[index][way].timestamp > (cycle + latency)) ? C[index][way].timestamp : (cycle + latency));
-         return (cycle + latency >= avail);
-      }
+void cache_t::replay(uint64_t cycle, bool read, uint64_t addr, bool pf, bool wb, const mem_access_timing_t &t) {
+   replay_timing = &t;
+   if (wb)
+      write_back(cycle, addr);
+   else
+      access(cycle, read, addr, pf);
+   replay_timing = (const mem_access_timing_t *)NULL;
+}
+
+uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf, uint64_t *level, const cache_lookup_t *path) {
+   switch (CacheGeometries(geometry)) {
+   case CacheGeometries::IC:
+      return(access_with<geometry_ic_t, repl_lru_t>(cycle, read, addr, pf, level, path));
+   case CacheGeometries::L1:
+      return(access_with<geometry_l1_t, repl_lru_t>(cycle, read, addr, pf, level, path));
+   case CacheGeometries::L2:
+      return(access_with<geometry_l2_t, repl_lru_t>(cycle, read, addr, pf, level, path));
+   case CacheGeometries::L3:
+      return(access_with<geometry_l3_t, repl_lru_t>(cycle, read, addr, pf, level, path));
+   default:
+      break;
    }
 
-   return false;
+   switch (ReplPolicies(repl)) {
+   case ReplPolicies::LRU:
+      if (wide_lru)
+         return(access_with<cache_geometry_any_t, repl_lru_wide_t>(cycle, read, addr, pf, level, path));
+      return(access_with<cache_geometry_any_t, repl_lru_t>(cycle, read, addr, pf, level, path));
+   case ReplPolicies::PLRU:
+      return(access_with<cache_geometry_any_t, repl_plru_t>(cycle, read, addr, pf, level, path));
+   case ReplPolicies::SRRIP:
+      return(access_with<cache_geometry_any_t, repl_srrip_t>(cycle, read, addr, pf, level, path));
+   case ReplPolicies::BRRIP:
+      return(access_with<cache_geometry_any_t, repl_brrip_t>(cycle, read, addr, pf, level, path));
+   default:
+      return(access_with<cache_geometry_any_t, repl_random_t>(cycle, read, addr, pf, level, path));
+   }
 }
 
-uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf) {
+template <class geom_t, class policy_t>
+uint64_t cache_t::access_with(uint64_t cycle, bool read, uint64_t addr, bool pf, uint64_t *level, const cache_lookup_t *path) {
+   const uint64_t ways = (geom_t::assoc ? geom_t::assoc : assoc);
    uint64_t avail;		// return value: cycle that requested block is available
-   uint64_t tag = TAG(addr);
-   uint64_t index = INDEX(addr);
-   bool hit = false;
+   uint64_t tag = tag_of<geom_t>(addr);
+   uint64_t index = index_of<geom_t>(addr);
    uint64_t way;		// if hit, this is the corresponding way
-   uint64_t max_lru_ctr = 0;	// for finding lru block
-   uint64_t victim_way;		// if miss, this is the lru/victim way
+
+   if (path && path->valid) {	// reuse the caller's lookup
+      assert((path->index == index) && (path->tag == tag));
+      way = path->way;
+   }
+   else {
+      way = find<geom_t, policy_t>(index, tag);
+   }
 
    accesses+=!pf;
    pf_accesses += pf;
 
-   for (way = 0; way < assoc; way++)
-   {
-      if (C[index][way].valid && (C[index][way].tag == tag))
-      {
-         hit = true;
-         break;
-      }
-      else if (C[index][way].lru >= max_lru_ctr)
-      {
-         max_lru_ctr = C[index][way].lru;
-         victim_way = way;
-      }
-   }
-
-   if (hit) {	// hit
+   if (way < ways) {	// hit
       // determine when the requested block will be available
-      avail = ((C[index][way].timestamp > (cycle + latency)) ? C[index][way].timestamp : (cycle + latency));
+      uint64_t timestamp = from_stamp(stamps_of<geom_t, policy_t>(index)[way], stamp_base);
+      avail = ((timestamp > (cycle + latency)) ? timestamp : (cycle + latency));
+      mshr_merges += (timestamp > (cycle + latency));	// the block is still on its way
+
+      if (!read)
+         dirty_of<geom_t, policy_t>(index)[way >> 6] |= (1ULL << (way & 63));
 
-      update_lru(index, way);	// make "way" the MRU way
+      if (!policy_t::touch_mru_is_noop || (way != mru_of<geom_t, policy_t>(index))) {
+         policy_t::touch(meta_of<geom_t, policy_t>(index), ways, way);
+         mru_of<geom_t, policy_t>(index) = way;
+      }
+
+      if (level) *level = 1;
    }
    else {	// miss
       misses+= !pf;
       pf_misses += pf;
 
-      assert(max_lru_ctr == (assoc - 1));
-      assert(victim_way < assoc);
-      
-      // TO DO: model writebacks (evictions of dirty blocks)
+      // the victim is an invalid way if there is one, otherwise the policy's choice
+      uint64_t victim_way = match_way<geom_t>(tags_of<geom_t, policy_t>(index), INVALID_TAG);
+      if (victim_way == ways)
+         victim_way = policy_t::victim(meta_of<geom_t, policy_t>(index), ways, repl_state);
+      assert(victim_way < ways);
+
+      // write back the victim if it is dirty; the requested block is dirty if written
+      uint64_t *d = dirty_of<geom_t, policy_t>(index);
+      uint64_t victim_bit = (1ULL << (victim_way & 63));
+      if (d[victim_way >> 6] & victim_bit) {
+         writebacks++;
+         evict_dirty((cycle + latency), addr_of(tags_of<geom_t, policy_t>(index)[victim_way], index));
+      }
+      if (read)
+         d[victim_way >> 6] &= ~victim_bit;
+      else
+         d[victim_way >> 6] |= victim_bit;
 
       // determine when the requested block will be available
-      avail = (next_level ? next_level->access((cycle + latency), read, addr, pf) : (cycle + latency + MAIN_MEMORY_LATENCY));
+      avail = fill((cycle + latency), addr, pf, level, path);
 
       // replace the victim block with the requested block
-      C[index][victim_way].valid = true;
-      C[index][victim_way].tag = tag;
-      C[index][victim_way].timestamp = avail;
-      update_lru(index, victim_way);  // make "victim_way" the MRU way
+      tags_of<geom_t, policy_t>(index)[victim_way] = tag;
+      stamps_of<geom_t, policy_t>(index)[victim_way] = to_stamp(avail, stamp_base);
+      policy_t::insert(meta_of<geom_t, policy_t>(index), ways, victim_way, repl_state);
+      mru_of<geom_t, policy_t>(index) = victim_way;
+   }
+
+   return(avail);
+}
+
+uint64_t cache_t::fill(uint64_t cycle, uint64_t addr, bool pf, uint64_t *level, const cache_lookup_t *path) {
+   uint64_t avail;
+
+   if (!next_level && !shared_next) {	// last level
+      if (level) *level = 2;
+      return(memory_access(cycle, true));
    }
 
+   // Wait for an MSHR that is free at least as long as the searches down to the level that has the block.
+   uint64_t start = (mshrs ? mshr_timeline.find(cycle, miss_latency(cycle, addr)) : cycle);
+
+   // The block is read from the next level, whether the miss was a read or a write.
+   if (next_level)
+      avail = next_level->access(start, true, addr, pf, level, (path ? (path + 1) : NULL));
+   else
+      avail = shared_next->access(start, true, addr, pf, level);
+   if (level) *level = (*level + 1);
+
+   if (mshrs) {
+      // The miss holds its MSHR until the block is available. If the next level took longer
+      // than the searches (waiting for its own MSHRs or the memory bus), misses timed earlier
+      // may hold all the MSHRs in the rest of that interval: the miss then starts once an MSHR
+      // is free for the whole of it, and takes as long from there (the next level has already
+      // been accessed, and is not accessed again).
+      uint64_t hold_start = mshr_timeline.find(start, (avail - start));
+      avail += (hold_start - start);
+      mshr_stall_cycles += (hold_start - cycle);
+      mshr_timeline.add(hold_start, avail);
+   }
    return(avail);
 }
 
-void cache_t::update_lru(uint64_t index, uint64_t mru_way) {
-   for (uint64_t way = 0; way < assoc; way++) {
-      if (C[index][way].lru < C[index][mru_way].lru) {
-         C[index][way].lru++;
-         assert(C[index][way].lru < assoc);
+uint64_t cache_t::miss_latency(uint64_t cycle, uint64_t addr) const {
+   if (next_level) {
+      cache_lookup_t l;
+      next_level->lookup(addr, l);
+      if (l.way < next_level->assoc)	// present, or on its way
+         return(next_level->latency);
+      return(next_level->latency + next_level->miss_latency((cycle + next_level->latency), addr));
+   }
+   else if (shared_next) {
+      return(shared_next->get_latency() + (shared_next->is_hit(cycle, addr) ? 0 : MAIN_MEMORY_LATENCY));
+   }
+   else {
+      return(MAIN_MEMORY_LATENCY);
+   }
+}
+
+void cache_t::write_back(uint64_t cycle, uint64_t addr) {
+   cache_lookup_t l;
+   if (lookup(addr, l))
+      dirty(l.index)[l.way >> 6] |= (1ULL << (l.way & 63));	// no replacement update: not a demand access
+   else
+      evict_dirty((cycle + latency), addr);
+}
+
+void cache_t::evict_dirty(uint64_t cycle, uint64_t addr) {
+   if (next_level) {
+      next_level->write_back(cycle, addr);
+   }
+   else if (shared_next) {
+      shared_next->write_back(cycle, addr);
+   }
+   else {
+      memory_access(cycle, false);
+   }
+}
+
+uint64_t cache_t::memory_access(uint64_t cycle, bool read) {
+   const mem_timing_t *replayed = (replay_timing ? (read ? &replay_timing->read : &replay_timing->write) : NULL);
+   mem_timing_t t;
+
+   if (replayed && replayed->valid) {
+      t = *replayed;
+   }
+   else {
+      t.valid = true;
+      t.mshr_start = ((read && mshrs) ? mshr_timeline.find(cycle, 1) : cycle);
+      while (true) {
+         t.bus_start = t.mshr_start;
+         t.bus_wait = 0;
+         if (transfer_cycles) {
+            // A read's block crosses the bus during the last "transfer_cycles" of the access, or later
+            // if the bus is busy. Nothing waits for a write, but it holds the bus.
+            uint64_t ready = (read ? (t.mshr_start + MAX(MAIN_MEMORY_LATENCY, transfer_cycles) - transfer_cycles) : cycle);
+            t.bus_start = bus_timeline.find(ready, transfer_cycles);
+            t.bus_wait = (read ? (t.bus_start - ready) : 0);
+         }
+         t.avail = (transfer_cycles ? (t.bus_start + transfer_cycles) : (t.mshr_start + MAIN_MEMORY_LATENCY));
+         if (!read || !mshrs)
+            break;
+
+         // A read holds its MSHR until the block is available. If an MSHR is not free for all of
+         // that interval (misses arrive out of cycle order), retry from where one is.
+         uint64_t hold_start = mshr_timeline.find(t.mshr_start, (t.avail - t.mshr_start));
+         if (hold_start == t.mshr_start)
+            break;
+         t.mshr_start = hold_start;
       }
    }
-   C[index][mru_way].lru = 0;
+   if (record_timing)
+      *(read ? &record_timing->read : &record_timing->write) = t;
+
+   if (read && mshrs) {
+      mshr_timeline.add(t.mshr_start, t.avail);
+      mshr_stall_cycles += (t.mshr_start - cycle);
+   }
+   if (transfer_cycles) {
+      bus_timeline.add(t.bus_start, (t.bus_start + transfer_cycles));
+      mem_transfers++;
+      mem_wait_cycles += t.bus_wait;
+   }
+   return(t.avail);
+}
+
+void cache_t::rebase(uint64_t new_base) {
+   assert(new_base >= stamp_base);
+   uint64_t delta = (new_base - stamp_base);
+   for (uint64_t i = 0; i <= index_mask; i++) {
+      stamp_t *s = stamps(i);
+      for (uint64_t way = 0; way < assoc; way++)
+         s[way] = rebase_stamp(s[way], delta);
+   }
+   stamp_base = new_base;
+}
+
+void cache_t::reset_stats() {
+   accesses = 0;
+   misses = 0;
+   pf_accesses = 0;
+   pf_misses = 0;
+   writebacks = 0;
+   mshr_merges = 0;
+   mshr_stall_cycles = 0;
+   mem_transfers = 0;
+   mem_wait_cycles = 0;
 }
 
 void cache_t::stats() {
@@ -147,4 +569,14 @@ void cache_t::stats() {
    printf("\tpf accesses   = %lu\n", pf_accesses);
    printf("\tpf misses     = %lu\n", pf_misses);
    printf("\tpf miss ratio = %.2f%%\n", 100.0*((double)pf_misses/(double)pf_accesses));
+   printf("\twritebacks = %lu\n", writebacks);
+   if (mshrs) {
+      printf("\tMSHRs = %lu\n", mshrs);
+      printf("\tMSHR merges       = %lu\n", mshr_merges);
+      printf("\tMSHR stall cycles = %lu\n", mshr_stall_cycles);
+   }
+   if (transfer_cycles && !next_level && !shared_next) {
+      printf("\tmemory transfers       = %lu (%lu cycles each)\n", mem_transfers, transfer_cycles);
+      printf("\tmemory bus wait cycles = %lu (reads)\n", mem_wait_cycles);
+   }
 }
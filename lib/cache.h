@@ -21,13 +21,72 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
+#ifndef _CACHE_H_
+#define _CACHE_H_
 
-struct block_t {
-	bool valid;
-	//bool dirty;	// TO DO
+
+#include "timestamp.h"
+#include "occupancy.h"
+
+// Tag store layout: the sets live in one contiguous, line-aligned allocation. Each set is
+// a run of "set_words" 64-bit words (rounded up to whole cache lines) holding, in order,
+// the tags of its ways, the ways' timestamps (cycle the block is available, relative to
+// the cache's stamp_base), the replacement policy's metadata (see replacement.h), the
+// ways' dirty bits, and the MRU way. Searching a set touches only its tag array, which is compared against
+// the requested tag a vector at a time. An invalid way holds INVALID_TAG, which no
+// address maps to.
+#define INVALID_TAG	(~(uint64_t)0)
+#define CACHE_LINE	64
+
+class shared_cache_port_t;
+
+// Names of the replacement policies, indexed by ReplPolicies (parameters.h).
+extern const char *repl_policy_names[];
+
+// Measurements of a cache, for combining the results of separately simulated regions.
+struct cache_stats_t {
+	uint64_t accesses;
+	uint64_t misses;
+	uint64_t pf_accesses;
+	uint64_t pf_misses;
+	uint64_t writebacks;
+	uint64_t mshr_merges;
+	uint64_t mshr_stall_cycles;
+	uint64_t mem_transfers;
+	uint64_t mem_wait_cycles;
+};
+
+// Result of looking up a block without side effects, for a following access() of the same
+// block to reuse instead of searching the set again. A lookup stays valid until the cache
+// is next accessed. A lookup path holds one entry per private cache level, starting at
+// the level looked up; levels that were not looked up are left invalid.
+struct cache_lookup_t {
+	bool valid = false;
+	uint64_t index;
 	uint64_t tag;
-	uint64_t timestamp;
-	uint64_t lru;
+	uint64_t way;		// "assoc" on a miss
+	uint64_t timestamp;	// on a hit: cycle the block is available
+};
+
+#define CACHE_MAX_LEVELS	3	// private levels of a lookup path (L1$, L2$, L3$)
+
+// Main memory timing of a block read or written by a last-level cache, as reserved on its
+// MSHR and memory bus timelines.
+struct mem_timing_t {
+	bool valid = false;	// reserved
+	uint64_t mshr_start;	// MSHR held from here until "avail" (reads, if MSHRs are limited)
+	uint64_t bus_start;	// memory bus held from here for the block transfer (if bandwidth is limited)
+	uint64_t bus_wait;	// cycles the transfer waited for the bus (reads)
+	uint64_t avail;		// cycle the block is available (reads)
+};
+
+// Main memory timing of one access or writeback to a last-level cache: the read of a missing
+// block, and the write of a dirty victim (or of a written-back block not in the cache). In
+// multi-core mode (see multicore.h), a core decides it during a quantum, and the barrier
+// applies it to the shared L3 as decided.
+struct mem_access_timing_t {
+	mem_timing_t read;
+	mem_timing_t write;
 };
 
 #define IsPow2(x)	(((x) & (x-1)) == 0)
@@ -35,32 +94,228 @@ struct block_t {
 #define TAG(addr)	((addr) >> (num_index_bits + num_offset_bits))
 #define INDEX(addr)	(((addr) >> num_offset_bits) & index_mask)
 
+// Compile-time cache geometry: block offset bits, set index bits and associativity. Caches
+// with the default hierarchy's geometries (see cache.cc) are searched and updated by code
+// specialized for them, with constant shifts and masks and unrolled way loops. Any other
+// geometry uses cache_geometry_any_t, whose zero associativity stands for the cache's
+// runtime geometry (TAG(), INDEX() and "assoc").
+template <uint64_t OFFSET_BITS, uint64_t INDEX_BITS, uint64_t ASSOC>
+struct cache_geometry_t {
+	static const uint64_t offset_bits = OFFSET_BITS;
+	static const uint64_t index_bits = INDEX_BITS;
+	static const uint64_t assoc = ASSOC;
+};
+typedef cache_geometry_t<0, 0, 0> cache_geometry_any_t;
+
+// Set layout: words before the policy metadata (tags and timestamps), words of dirty
+// bits, and words per set.
+static inline uint64_t cache_meta_offset(uint64_t assoc) {
+	return(assoc + (((assoc * sizeof(stamp_t)) + 7) / 8));
+}
+static inline uint64_t cache_dirty_words(uint64_t assoc) {
+	return((assoc + 63) / 64);
+}
+static inline uint64_t cache_set_words(uint64_t assoc, uint64_t meta_words) {
+	uint64_t set_bytes = (((cache_meta_offset(assoc) + meta_words + cache_dirty_words(assoc)) * sizeof(uint64_t)) + sizeof(uint16_t));
+	return((((set_bytes + CACHE_LINE - 1) / CACHE_LINE) * CACHE_LINE) / sizeof(uint64_t));
+}
+
 class cache_t {
 private:
-	block_t **C;
+	uint64_t *store;
+	uint64_t heat;		// arena_heat_t of "store"
+	uint64_t set_words;
+	uint64_t meta_offset;	// words before the replacement metadata, within a set
+	uint64_t meta_words;	// words of replacement metadata per set
 	uint64_t num_index_bits;
 	uint64_t num_offset_bits;
 	uint64_t index_mask;
 	uint64_t assoc;
 
+	// compile-time geometry of this cache (CacheGeometries in cache.cc), if any
+	uint64_t geometry;
+
+	// replacement policy (ReplPolicies), and its per-cache state (see replacement.h)
+	uint64_t repl;
+	bool wide_lru;		// LRU with more than 16 ways
+	bool touch_mru_is_noop;	// the policy's, see replacement.h
+	uint64_t repl_state;
+
 	// latency to search this cache for requested block
 	uint64_t latency;
 
+	// Miss status holding registers (0: unlimited): the cycles each is held, from the
+	// miss until its block is available. Misses to a block already on its way merge
+	// with its miss (they hit the block's future timestamp) and need no MSHR.
+	uint64_t mshrs;
+	occupancy_timeline_t mshr_timeline;
+
+	// Main memory bus, used by the last cache level when MAIN_MEMORY_BANDWIDTH is not 0:
+	// each block transfer (fill or writeback) holds it for "transfer_cycles".
+	uint64_t transfer_cycles;
+	occupancy_timeline_t bus_timeline;
+
+	// epoch base of the block timestamps
+	uint64_t stamp_base;
+
 	// pointer to next cache level if applicable
 	cache_t *next_level;
 
+	// port to a next cache level shared with other cores (multi-core mode), if applicable
+	shared_cache_port_t *shared_next;
+
 	// measurements
 	uint64_t accesses;
 	uint64_t pf_accesses;
 	uint64_t misses;
 	uint64_t pf_misses;
+	uint64_t writebacks;		// dirty blocks evicted
+	uint64_t mshr_merges;		// misses to a block already on its way
+	uint64_t mshr_stall_cycles;	// cycles misses waited for an MSHR
+	uint64_t mem_transfers;		// main memory reads and writes (last level)
+	uint64_t mem_wait_cycles;	// cycles they waited for the memory bus
+
+	uint64_t *tags(uint64_t index) const { return(store + (index * set_words)); }
+	stamp_t *stamps(uint64_t index) const { return((stamp_t *)(tags(index) + assoc)); }
+	uint64_t *meta(uint64_t index) const { return(tags(index) + meta_offset); }
+	uint64_t *dirty(uint64_t index) const { return(meta(index) + meta_words); }
+	uint16_t &mru(uint64_t index) const { return(*(uint16_t *)(dirty(index) + cache_dirty_words(assoc))); }
+
+	// The same, with constant offsets for a compile-time geometry. The runtime geometry
+	// (cache_geometry_any_t) takes the layout from the members above, whatever "policy_t".
+	template <class geom_t, class policy_t> uint64_t *tags_of(uint64_t index) const {
+	   return(store + (index * (geom_t::assoc ? cache_set_words(geom_t::assoc, policy_t::words(geom_t::assoc)) : set_words)));
+	}
+	template <class geom_t, class policy_t> stamp_t *stamps_of(uint64_t index) const {
+	   return((stamp_t *)(tags_of<geom_t, policy_t>(index) + (geom_t::assoc ? geom_t::assoc : assoc)));
+	}
+	template <class geom_t, class policy_t> uint64_t *meta_of(uint64_t index) const {
+	   return(tags_of<geom_t, policy_t>(index) + (geom_t::assoc ? cache_meta_offset(geom_t::assoc) : meta_offset));
+	}
+	template <class geom_t, class policy_t> uint64_t *dirty_of(uint64_t index) const {
+	   return(meta_of<geom_t, policy_t>(index) + (geom_t::assoc ? policy_t::words(geom_t::assoc) : meta_words));
+	}
+	template <class geom_t, class policy_t> uint16_t &mru_of(uint64_t index) const {
+	   return(*(uint16_t *)(dirty_of<geom_t, policy_t>(index) + cache_dirty_words(geom_t::assoc ? geom_t::assoc : assoc)));
+	}
 
-	void update_lru(uint64_t index, uint64_t mru_way);
+	template <class geom_t> uint64_t tag_of(uint64_t addr) const {
+	   return(geom_t::assoc ? (addr >> (geom_t::index_bits + geom_t::offset_bits)) : TAG(addr));
+	}
+	template <class geom_t> uint64_t index_of(uint64_t addr) const {
+	   return(geom_t::assoc ? ((addr >> geom_t::offset_bits) & ((1ULL << geom_t::index_bits) - 1)) : INDEX(addr));
+	}
+	uint64_t addr_of(uint64_t tag, uint64_t index) const {	// address of a block
+	   return(((tag << num_index_bits) | index) << num_offset_bits);
+	}
+
+	// Way of "t" (a set's tags) holding "tag", or "assoc" if none does.
+	template <class geom_t> uint64_t match_way(const uint64_t *t, uint64_t tag) const;
+	// Way of set "index" holding "tag", or "assoc" if none does.
+	template <class geom_t, class policy_t> uint64_t find(uint64_t index, uint64_t tag) const;
+
+	// lookup(), access() and set initialization, for each geometry and replacement policy
+	template <class geom_t, class policy_t> bool lookup_in(uint64_t addr, cache_lookup_t &l) const;
+	template <class geom_t, class policy_t> uint64_t access_with(uint64_t cycle, bool read, uint64_t addr, bool pf, uint64_t *level, const cache_lookup_t *path);
+	template <class policy_t> void init_sets(uint64_t heat);
+
+	// Fetch a missing block from the next level (or main memory), with the search starting
+	// at "cycle" (after this cache's latency), once an MSHR is free for the whole miss. Returns when it is available.
+	uint64_t fill(uint64_t cycle, uint64_t addr, bool pf, uint64_t *level, const cache_lookup_t *path);
+	// Fewest cycles a miss of "addr" at "cycle" takes to get its block from the next level:
+	// the searches down to the level that has it (or main memory), without waiting.
+	uint64_t miss_latency(uint64_t cycle, uint64_t addr) const;
+	// Send a dirty block evicted at "cycle" to the next level (or main memory).
+	void evict_dirty(uint64_t cycle, uint64_t addr);
+	// Main memory read (after an MSHR is free) or write of a block requested at "cycle",
+	// through the memory bus: timed now, or as "replay_timing" decided. Returns when it is available.
+	uint64_t memory_access(uint64_t cycle, bool read);
+
+	// Main memory timing decided elsewhere, applied by replay() (NULL otherwise), and where
+	// this cache records the timing it decides (NULL: not recorded).
+	const mem_access_timing_t *replay_timing;
+	mem_access_timing_t *record_timing;
 
 public:
-	cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t latency, cache_t *next_level);
+	// "heat" is the arena_heat_t (arena.h) of the tag store: how often the cache is accessed.
+	// "mshrs" limits the misses outstanding at once (0: unlimited).
+	cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t latency, cache_t *next_level, uint64_t repl, uint64_t mshrs, uint64_t heat);
+	cache_t(const cache_t &) = delete;	// owns its tag store
+	cache_t &operator=(const cache_t &) = delete;
 	~cache_t();
-	uint64_t access(uint64_t cycle, bool read, uint64_t addr, bool pf = false);
+	// If "level" is not NULL, it receives the level that supplied the block: 1 for this cache,
+	// 2 for the next level, and so on, with main memory one past the last cache.
+	// "path", if not NULL, is a lookup path of "addr" (CACHE_MAX_LEVELS entries, see
+	// hit_level()) whose valid entries are reused instead of searching again.
+	uint64_t access(uint64_t cycle, bool read, uint64_t addr, bool pf = false, uint64_t *level = NULL, const cache_lookup_t *path = NULL);
     bool is_hit(uint64_t cycle, uint64_t addr) const;
+
+	// Accept a dirty block evicted from the level above at "cycle". The block is marked dirty
+	// if present; otherwise it goes on to the next level (or main memory) without allocating.
+	void write_back(uint64_t cycle, uint64_t addr);
+
+	// Search for "addr" without side effects, filling "l". Returns true if the block is present.
+	bool lookup(uint64_t addr, cache_lookup_t &l) const;
+	// True if the block of lookup "l" is present and available by "cycle" plus the search latency.
+	bool is_hit(uint64_t cycle, const cache_lookup_t &l) const { return((l.way < assoc) && (l.timestamp <= (cycle + latency))); }
+
+	// Walk the hierarchy from this cache to the first level that would hit at "cycle" (as
+	// is_hit()), without side effects. Returns that level (1 for this cache), or main memory
+	// one past the last cache. "path" (CACHE_MAX_LEVELS entries) receives the private levels' lookups.
+	uint64_t hit_level(uint64_t cycle, uint64_t addr, cache_lookup_t *path) const;
+
+	// Multi-core mode (see multicore.h). A core's copy of a shared last-level cache ("from",
+	// same parameters) takes its stamp base, replacement state and MSHR and memory bus
+	// occupancy with sync(), and its sets one at a time with copy_set() (the set of "addr").
+	// The copy records the main memory timing of each access or writeback in "t" (NULL: stop
+	// recording), and the shared cache replays it at the barrier: access() (or write_back()
+	// if "wb") reserving main memory as "t" decided, where it is valid, instead of timing it again.
+	void sync(const cache_t &from);
+	void copy_set(const cache_t &from, uint64_t addr);
+	uint64_t set_of(uint64_t addr) const { return(INDEX(addr)); }
+	void record(mem_access_timing_t *t) { record_timing = t; }
+	void replay(uint64_t cycle, bool read, uint64_t addr, bool pf, bool wb, const mem_access_timing_t &t);
+
+	// Make misses go to a shared next level through "port" (instead of "next_level").
+	void set_shared_next(shared_cache_port_t *port) { shared_next = port; }
+	// Move the timestamps' epoch base forward to "new_base", which no later access precedes.
+	void rebase(uint64_t new_base);
+	uint64_t get_stamp_base() const { return(stamp_base); }
+	// Forget the MSHR and memory bus occupancy before "cycle", which no later access precedes.
+	void prune(uint64_t cycle) {
+	   mshr_timeline.prune(cycle);
+	   bus_timeline.prune(cycle);
+	}
+
+	void reset_stats();	// clear measurements, e.g., at the end of warm-up
 	void stats();
+
+	// Block number of "addr": the address without its block offset.
+	uint64_t block(uint64_t addr) const { return(addr >> num_offset_bits); }
+
+	// Count a read of the block accessed just before, without searching: it is still
+	// resident and MRU, so access() would only return the (later) requesting cycle.
+	// Only valid if repeat_hit_is_noop(): otherwise the hit updates the replacement state.
+	void count_repeat_hit() { accesses++; }
+	bool repeat_hit_is_noop() const { return(touch_mru_is_noop); }
+
+	uint64_t get_latency() const { return(latency); }
+	uint64_t get_accesses() const { return(accesses); }
+	uint64_t get_misses() const { return(misses); }
+
+	uint64_t footprint() const;	// host memory of the tag array and timelines, in bytes
+	cache_stats_t get_stats() const { return {accesses, misses, pf_accesses, pf_misses, writebacks, mshr_merges, mshr_stall_cycles, mem_transfers, mem_wait_cycles}; }
+	void add_stats(const cache_stats_t &s) {
+	   accesses += s.accesses;
+	   misses += s.misses;
+	   pf_accesses += s.pf_accesses;
+	   pf_misses += s.pf_misses;
+	   writebacks += s.writebacks;
+	   mshr_merges += s.mshr_merges;
+	   mshr_stall_cycles += s.mshr_stall_cycles;
+	   mem_transfers += s.mem_transfers;
+	   mem_wait_cycles += s.mem_wait_cycles;
+	}
 };
+
+#endif
@@ -27,6 +27,9 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <inttypes.h>
 #include <assert.h>
 #include <string.h>
+#include <signal.h>
+#include <string>
+#include <thread>
 #include "cvp.h"
 #include "cvp_trace_reader.h"
 #include "fifo.h"
@@ -35,9 +38,34 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "resource_schedule.h"
 #include "uarchsim.h"
 #include "parameters.h"
+#include "trace_index.h"
+#include "profiler.h"
+#include "multicore.h"
+#include "shard.h"
+#include "bp_ahead.h"
+#include "bp_sidecar.h"
+#include "stack_dist.h"
+#include "interval_stats.h"
 
 uarchsim_t *sim;
 
+// Build the random-access index of the trace and exit.
+bool build_index = false;
+
+// Profile LRU stack distances instead of simulating, and exit.
+bool stack_profile = false;
+
+// Replacement policy named "name" (see repl_policy_names), into "repl". Returns false if unknown.
+static bool parse_repl(const char *name, uint64_t &repl) {
+   for (uint64_t r = 0; r < (uint64_t)ReplPolicies::NumPolicies; r++) {
+      if (!strcmp(name, repl_policy_names[r])) {
+         repl = r;
+         return(true);
+      }
+   }
+   return(false);
+}
+
 int parseargs(int argc, char ** argv) {
   int i = 1;
 
@@ -84,6 +112,39 @@ int parseargs(int argc, char ** argv) {
         PERFECT_INDIRECT_PRED = true;
         i++;
      }
+     else if (!strcmp(argv[i], "-a"))
+     {
+        BP_AHEAD = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-c"))
+     {
+        i++;
+        if (i < argc)
+        {
+           BP_SIDECAR_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing branch outcome sidecar file: -c <file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-O"))
+     {
+        i++;
+        if (i < argc)
+        {
+           ORACLE_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing oracle overrides file: -O <file>.\n");
+           exit(0);
+        }
+     }
      else if (!strcmp(argv[i], "-P"))
      {
         PREFETCHER_ENABLE = true;
@@ -117,6 +178,20 @@ int parseargs(int argc, char ** argv) {
            exit(0);
         }
      }
+     else if (!strcmp(argv[i], "-U"))
+     {
+        i++;
+        if (i < argc)
+        {
+           FU_POOLS = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing functional-unit pools: -U <name>=<classes>:<width>:<latency>[:<interval>][,...].\n");
+           exit(0);
+        }
+     }
      else if (!strcmp(argv[i], "-A"))
      {
         i++;
@@ -229,6 +304,226 @@ int parseargs(int argc, char ** argv) {
            exit(0);
         }
      }
+     else if (!strcmp(argv[i], "-R"))
+     {
+        i++;
+        char ic[16], l1[16], l2[16], l3[16];
+        if ((i < argc) &&
+            (sscanf(argv[i], "%15[^,],%15[^,],%15[^,],%15s", ic, l1, l2, l3) == 4) &&
+            parse_repl(ic, IC_REPL) && parse_repl(l1, L1_REPL) && parse_repl(l2, L2_REPL) && parse_repl(l3, L3_REPL))
+        {
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing or unknown replacement policies: -R <ic>,<l1>,<l2>,<l3> (each lru, plru, srrip, brrip or random).\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-Q"))
+     {
+        i++;
+        if ((i < argc) &&
+            (sscanf(argv[i], "%lu,%lu,%lu,%lu,%lu", &IC_MSHRS, &L1_MSHRS, &L2_MSHRS, &L3_MSHRS, &MAIN_MEMORY_BANDWIDTH) == 5))
+        {
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing one or more memory queuing parameters: -Q <ic_mshrs>,<L1_mshrs>,<L2_mshrs>,<L3_mshrs>,<main_memory_bytes_per_cycle> (0: unlimited).\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-S"))
+     {
+        i++;
+        if (i < argc)
+        {
+           SKIP_INSTS = strtoull(argv[i], NULL, 0);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing # instructions to skip: -S <skip_insts>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-W"))
+     {
+        i++;
+        if (i < argc)
+        {
+           WARMUP_INSTS = strtoull(argv[i], NULL, 0);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing # warm-up instructions: -W <warmup_insts>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-N"))
+     {
+        i++;
+        if (i < argc)
+        {
+           MAX_INSTS = strtoull(argv[i], NULL, 0);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing max. # instructions: -N <max_insts>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-T"))
+     {
+        i++;
+        const char *comma = ((i < argc) ? strchr(argv[i], ',') : NULL);
+        if (comma && comma[1])
+        {
+           INTERVAL_INSTS = strtoull(argv[i], NULL, 0);
+           INTERVAL_STATS_FILE = (comma + 1);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing interval statistics parameters: -T <interval_insts>,<file (.csv or .bin)>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-J"))
+     {
+        i++;
+        if (i < argc)
+        {
+           PROFILE_TRACE_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing profile trace file: -J <chrome_trace.json>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-V"))
+     {
+        i++;
+        unsigned long long temp1, temp2;
+        int n = 0;
+        if ((i < argc) && (sscanf(argv[i], "%llu,%llu,%n", &temp1, &temp2, &n) == 2) && n && argv[i][n])
+        {
+           PIPEVIEW_START = (uint64_t)temp1;
+           PIPEVIEW_COUNT = (uint64_t)temp2;
+           PIPEVIEW_FILE = (argv[i] + n);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing pipeline view parameters: -V <start_inst>,<num_insts>,<file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-L"))
+     {
+        i++;
+        if (i < argc)
+        {
+           LIVE_STATS_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing live statistics file: -L <file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-G"))
+     {
+        i++;
+        unsigned long long temp;
+        if ((i < argc) && (sscanf(argv[i], "%llu", &temp) == 1) && (temp > 0))
+        {
+           MEMORY_BUDGET = ((uint64_t)temp << 20);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing memory budget: -G <megabytes>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-C"))
+     {
+        i++;
+        unsigned long long temp1, temp2;
+        if ((i < argc) && (sscanf(argv[i], "%llu,%llu", &temp1, &temp2) == 2) && (temp1 > 0) && (temp2 > 0))
+        {
+           NUM_CORES = (uint64_t)temp1;
+           QUANTUM_CYCLES = (uint64_t)temp2;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing multi-core parameters: -C <num_cores>,<quantum_cycles>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-j"))
+     {
+        i++;
+        unsigned long long temp1, temp2;
+        unsigned int temp3 = 0;
+        int n = ((i < argc) ? sscanf(argv[i], "%llu,%llu,%u", &temp1, &temp2, &temp3) : 0);
+        if (((n == 2) || (n == 3)) && (temp1 > 0))
+        {
+           NUM_SHARDS = (uint64_t)temp1;
+           SHARD_OVERLAP = (uint64_t)temp2;
+           SHARD_VERIFY = (temp3 ? true : false);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing sharding parameters: -j <num_shards>,<overlap_insts>[,<verify>].\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-E"))
+     {
+        i++;
+        unsigned long long temp1;
+        double temp2;
+        int n = 0;
+        if ((i < argc) && (sscanf(argv[i], "%llu,%lf%n", &temp1, &temp2, &n) == 2) && (temp1 > 0) && (temp2 > 0.0) &&
+            ((argv[i][n] == '\0') || ((argv[i][n] == ',') && (strspn((argv[i] + n + 1), CONV_METRIC_LETTERS) == strlen(argv[i] + n + 1)))))
+        {
+           CONVERGENCE_INTERVAL = (uint64_t)temp1;
+           CONVERGENCE_REL_ERR = temp2;
+           if (argv[i][n] == ',')
+              CONVERGENCE_METRICS = (argv[i] + n + 1);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing or unknown early termination parameters: -E <interval_insts>,<rel_err>[,<metrics>] (metrics: any of i, m, v).\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-x"))
+     {
+        build_index = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-X"))
+     {
+        HUGE_PAGES = false;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-H"))
+     {
+        stack_profile = true;
+        i++;
+     }
      else if (!strcmp(argv[i], "-w"))
      {
         i++;
@@ -249,22 +544,120 @@ int parseargs(int argc, char ** argv) {
      }
   }
 
-  if (i < argc) {
+  if ((i + (NUM_CORES ? NUM_CORES : 1)) <= argc) {
      return(i);
   }
   else {
-     printf("usage:\t%s\n\t[optional: -v to enable value prediction]\n\t[optional: -p to enable perfect value prediction (if -v also specified)]\n\t[optional: -d to enable perfect data cache]\n\t[optional: -b to enable perfect branch prediction (all branch types)]\n\t[optional: -i to enable perfect indirect-branch prediction]\n\t[optional: -P to enable stride prefetcher in L1D]\n\t[optional: -f <pipeline_fill_latency>]\n\t[optional: -M <num_ldst_lanes>\n\t[optional: -A <num_alu_lanes>\n\t[optional: -F <fetch_width>,<fetch_num_branch>,<fetch_stop_at_indirect>,<fetch_stop_at_taken>,<fetch_model_icache>]\n\t[optional: -I <log2_ic_size>,<ic_assoc>,<ic_blocksize>]\n\t[optional: -D <log2_L1_size>,<L1_assoc>,<L1_blocksize>,<L1_latency>,<log2_L2_size>,<L2_assoc>,<L2_blocksize>,<L2_latency>,<log2_L3_size>,<L3_assoc>,<L3_blocksize>,<L3_latency>,<main_memory_latency>]\n\t[optional: -w <window_size>]\n\t[REQUIRED: .gz trace file]\n\t[optional: contestant's arguments]\n", argv[0]);
+     printf("usage:\t%s\n\t[optional: -v to enable value prediction]\n\t[optional: -p to enable perfect value prediction (if -v also specified)]\n\t[optional: -d to enable perfect data cache]\n\t[optional: -b to enable perfect branch prediction (all branch types)]\n\t[optional: -i to enable perfect indirect-branch prediction]\n\t[optional: -a to run branch prediction on a separate thread, ahead of the timing model]\n\t[optional: -c <file> to reuse branch prediction outcomes from a sidecar file (recorded if missing or stale)]\n\t[optional: -O <file> of PCs or PC ranges to get perfect value prediction (vp), L1 hits (l1) or branch prediction (bp)]\n\t[optional: -P to enable stride prefetcher in L1D]\n\t[optional: -f <pipeline_fill_latency>]\n\t[optional: -M <num_ldst_lanes>\n\t[optional: -A <num_alu_lanes>\n\t[optional: -U <name>=<classes>:<width>:<latency>[:<interval>][,...] functional-unit pools (classes: a alu, b branch, j jump, i indirect, f fp, s slow alu)]\n\t[optional: -F <fetch_width>,<fetch_num_branch>,<fetch_stop_at_indirect>,<fetch_stop_at_taken>,<fetch_model_icache>]\n\t[optional: -I <log2_ic_size>,<ic_assoc>,<ic_blocksize>]\n\t[optional: -D <log2_L1_size>,<L1_assoc>,<L1_blocksize>,<L1_latency>,<log2_L2_size>,<L2_assoc>,<L2_blocksize>,<L2_latency>,<log2_L3_size>,<L3_assoc>,<L3_blocksize>,<L3_latency>,<main_memory_latency>]\n\t[optional: -R <ic>,<l1>,<l2>,<l3> replacement policy of each cache: lru (default), plru, srrip, brrip or random]\n\t[optional: -Q <ic_mshrs>,<L1_mshrs>,<L2_mshrs>,<L3_mshrs>,<main_memory_bytes_per_cycle> to limit outstanding misses and main memory bandwidth (0: unlimited, the default)]\n\t[optional: -w <window_size>]\n\t[optional: -S <skip_insts> (fast-forward, uses <trace>.idx if present)]\n\t[optional: -W <warmup_insts> (simulated, excluded from measurements)]\n\t[optional: -N <max_insts> (measured instructions after warm-up)]\n\t[optional: -T <interval_insts>,<file> (time-series every interval_insts, CSV or binary if file ends in .bin)]\n\t[optional: -J <file> to export a Chrome-trace JSON of simulator phases (requires make PROFILE=1)]\n\t[optional: -V <start_inst>,<num_insts>,<file> to export a pipeline view (gem5 O3PipeView format) of num_insts micro-ops]\n\t[optional: -L <file> to mirror key counters into a memory-mapped file while simulating (see live_stats.h for the layout)]\n\t[optional: -G <megabytes> to stop at startup if the simulator's structures would need more host memory]\n\t[optional: -X to allocate the large tables with the host's default page size instead of 2 MB huge pages]\n\t[optional: -C <num_cores>,<quantum_cycles> for multi-core simulation with a shared L3 (one trace per core)]\n\t[optional: -j <num_shards>,<overlap_insts>[,<verify>] to simulate the trace in parallel shards, each warmed up with overlap_insts (verify=1: compare with a serial run)]\n\t[optional: -E <interval_insts>,<rel_err>[,<metrics>] to stop once the 95%% confidence interval of per-interval metrics (i: IPC (always), m: branch MPKI, v: VP coverage) is within rel_err (e.g., 0.01)]\n\t[optional: -x to build <trace>.idx for fast-forwarding, then exit]\n\t[optional: -H to profile LRU stack distances (miss ratio of every power-of-two cache size) instead of simulating, then exit]\n\t[REQUIRED: .gz trace file (num_cores .gz trace files with -C)]\n\t[optional: contestant's arguments]\n", argv[0]);
      exit(0);
   }
 }
 
+// Fail fast if the simulator's structures would exceed the memory budget (-G).
+static void check_memory_budget(uint64_t bytes) {
+  if (MEMORY_BUDGET && (bytes > MEMORY_BUDGET)) {
+     printf("Error: the configuration needs %.1f MB of host memory, more than the budget of %lu MB (-G).\n",
+            ((double)bytes/(double)(1 << 20)), (MEMORY_BUDGET >> 20));
+     exit(1);
+  }
+}
+
 int main(int argc, char ** argv)
 {
   int i = parseargs(argc, argv);
-  CVPTraceReader reader(argv[i]);
+  const char *trace_name = argv[i];
+  std::string index_name = std::string(trace_name) + ".idx";
+
+  if (build_index) {
+     trace_index_t index;
+     if (!index.build(trace_name) || !index.save(index_name.c_str())) {
+        printf("Error: could not build trace index %s.\n", index_name.c_str());
+        exit(1);
+     }
+     printf("Trace index %s: %lu instructions, %lu access points.\n", index_name.c_str(), index.size(), index.num_points());
+     exit(0);
+  }
+
+  // Analysis mode: one pass over the trace, no timing simulation.
+  if (stack_profile) {
+     CVPTraceReader reader(trace_name);
+     if (SKIP_INSTS)
+        trace_fast_forward(reader, trace_name, SKIP_INSTS);
+     stack_dist_profile(reader);
+     exit(0);
+  }
+
+  // SIGUSR1 requests an interim report (see simulate_inst()).
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = request_interim_report;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &sa, (struct sigaction *)NULL);
+
+  if (NUM_SHARDS) {
+     if (NUM_CORES || INTERVAL_INSTS || PIPEVIEW_FILE || CONVERGENCE_INTERVAL || LIVE_STATS_FILE || BP_AHEAD || BP_SIDECAR_FILE) {
+        printf("Error: -a, -c, -C, -E, -L, -T and -V are not supported in sharded simulation (-j).\n");
+        exit(1);
+     }
+     if (MEMORY_BUDGET) {
+        // One simulator per running shard process (shards plus the serial reference, at most one per hardware thread).
+        uint64_t procs = (NUM_SHARDS + (SHARD_VERIFY ? 1 : 0));
+        uint64_t max_procs = std::thread::hardware_concurrency();
+        if (max_procs && (max_procs < procs))
+           procs = max_procs;
+        uarchsim_t *probe = new uarchsim_t;
+        check_memory_budget(probe->footprint(false) * procs);
+        delete probe;
+     }
+     run_sharded(trace_name, NUM_SHARDS, SHARD_OVERLAP, SHARD_VERIFY, (argc - (i + 1)), ((i + 1) < argc) ? &(argv[i + 1]) : (char **)NULL);
+     exit(0);
+  }
+
+  if (NUM_CORES) {
+     // The value predictor interface keeps global state, so cores cannot share it.
+     if (VP_ENABLE && !VP_PERFECT) {
+        printf("Error: multi-core simulation (-C) supports only perfect value prediction (-v -p).\n");
+        exit(1);
+     }
+     if (INTERVAL_INSTS || PIPEVIEW_FILE || LIVE_STATS_FILE || BP_AHEAD || BP_SIDECAR_FILE) {
+        printf("Error: -a, -c, -L, -T and -V are not supported in multi-core simulation (-C).\n");
+        exit(1);
+     }
+
+     multicore_t *mc = new multicore_t(NUM_CORES, &argv[i], QUANTUM_CYCLES);
+     check_memory_budget(mc->footprint());
+
+     i += NUM_CORES;
+     if (i < argc)
+        beginPredictor((argc - i), &(argv[i]));
+     else
+        beginPredictor(0, (char **)NULL);
+
+     mc->run();
+
+     endPredictor();
+     mc->output();
+#ifdef CVP_PROFILE
+     profiler.output();	// core 0 (the profiler is per host thread)
+#endif
+     delete mc;
+     exit(0);
+  }
+
+  CVPTraceReader reader(trace_name);
+
+  // Fast-forward: jump to the nearest indexed point when an index is available, then decode the rest without simulating.
+  if (SKIP_INSTS)
+     trace_fast_forward(reader, trace_name, SKIP_INSTS);
+
+  // Branch outcome sidecar: a matching one replaces the branch predictors (nothing to predict with -b).
+  bp_sidecar_t *sidecar = ((BP_SIDECAR_FILE && !PERFECT_BRANCH_PRED) ? (new bp_sidecar_t(BP_SIDECAR_FILE, trace_name, (MAX_INSTS ? (WARMUP_INSTS + MAX_INSTS) : 0))) : ((bp_sidecar_t *)NULL));
+  bool bp_tables = !(sidecar && sidecar->is_loaded());
 
   // Need to create simulator after parsing arguments (for global parameters).
-  sim = new uarchsim_t;
+  sim = new uarchsim_t((shared_cache_port_t *)NULL, bp_tables);
+  check_memory_budget(sim->footprint(false));
  
   // Get to next (optional) argument after trace filename.
   i++;
@@ -273,12 +666,40 @@ int main(int argc, char ** argv)
   else
      beginPredictor(0, (char **)NULL);
 
-  db_t *inst = nullptr; 
-  while (inst = reader.get_inst()) {
-    sim->step(inst);
-    delete inst;
-  }
+#ifdef CVP_PROFILE
+  if (PROFILE_TRACE_FILE)
+     profiler.enable_trace();
+#else
+  if (PROFILE_TRACE_FILE)
+     printf("Warning: -J ignored, the simulator was not built with PROFILE=1.\n");
+#endif
+
+  // Decoupled branch prediction: decode and predict on another thread (nothing to predict with -b or a loaded sidecar).
+  bp_t *bp = sim->get_bp();
+  bp_ahead_t *ahead = ((BP_AHEAD && !PERFECT_BRANCH_PRED && bp_tables) ? (new bp_ahead_t(&reader, bp)) : ((bp_ahead_t *)NULL));
 
+  uint64_t num_sim = 0;
+  while (simulate_inst(&reader, sim, num_sim, ahead, sidecar))
+     ;
+  // Stopped short of the end of the trace by the length limit or early termination?
+  bool complete = (!(MAX_INSTS && (num_sim == (WARMUP_INSTS + MAX_INSTS))) && !sim->converged());
+
+  if (ahead)
+     delete ahead;
+  if (sidecar) {
+     if (!sidecar->is_loaded() && !sidecar->save(complete))
+        printf("Error: could not write branch outcome sidecar %s.\n", BP_SIDECAR_FILE);
+     delete sidecar;
+  }
   endPredictor();
+  sim->close_interval_stats();
+  sim->close_pipeview();
+  sim->close_live_stats();
   sim->output();
+
+#ifdef CVP_PROFILE
+  profiler.output();
+  if (PROFILE_TRACE_FILE && !profiler.export_chrome_trace(PROFILE_TRACE_FILE))
+     printf("Error: could not write profile trace %s.\n", PROFILE_TRACE_FILE);
+#endif
 }
@@ -239,7 +239,7 @@ struct CVPTraceReader
     }
   };
 
-  gz::igzstream * dpressed_input;
+  std::istream * dpressed_input;
 
   // Buffer to hold trace instruction information
   Instr mInstr;
@@ -263,6 +263,9 @@ struct CVPTraceReader
   // Number of instructions processed so far.
   uint64_t nInstr;
 
+  // Number of uncompressed bytes consumed so far (the offset of the next byte in the trace).
+  uint64_t nBytes;
+
   // This simply tracks how many lanes one SIMD register have been processed.
   // In this case, since SIMD is 128 bits and pieces output 64 bits, if it is pair and we are creating an instruction object from a trace instruction, this means that
   // the output of the instruction object will contain the low order bits of the SIMD register.
@@ -272,10 +275,32 @@ struct CVPTraceReader
   // Note that there is no check for trace existence, so modify to suit your needs.
   CVPTraceReader(const char * trace_name)
   {
-    dpressed_input = new gz::igzstream();
-    dpressed_input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+    gz::igzstream * input = new gz::igzstream();
+    input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+    dpressed_input = input;
+
+    mCrackRegIdx = mCrackValIdx = mRemainingPieces = mSizeFactor = nInstr = nBytes = start_fp_reg =  0;
+  }
+
+  // Continue reading from another stream, which must be positioned at the start of a trace instruction.
+  // num_instr and num_bytes are the number of trace instructions and bytes that precede that position.
+  void reposition(std::istream * input, uint64_t num_instr, uint64_t num_bytes)
+  {
+    if(dpressed_input)
+      delete dpressed_input;
+    dpressed_input = input;
+
+    mInstr.reset();
+    mCrackRegIdx = mCrackValIdx = mRemainingPieces = mSizeFactor = start_fp_reg = 0;
+    nInstr = num_instr;
+    nBytes = num_bytes;
+  }
 
-    mCrackRegIdx = mCrackValIdx = mRemainingPieces = mSizeFactor = nInstr = start_fp_reg =  0;
+  // Approximate host memory of a reader: this object, the stream, and zlib's state for a gzip
+  // file (the 32KB inflate window, about 7KB of inflate state, and 8KB/16KB input/output buffers).
+  static uint64_t footprint()
+  {
+    return sizeof(CVPTraceReader) + sizeof(gz::igzstream) + (32768 + 7168 + 8192 + 16384);
   }
 
   ~CVPTraceReader()
@@ -305,6 +330,21 @@ struct CVPTraceReader
 
   }
 
+  // Skips up to n instruction objects (pieces) without creating them.
+  // Returns the number skipped, which is less than n only if the trace is done.
+  uint64_t skip(uint64_t n)
+  {
+    db_t scratch;
+    uint64_t skipped = 0;
+
+    while(skipped < n && (mRemainingPieces || readInstr()))
+    {
+      populateInstr(&scratch);
+      skipped++;
+    }
+    return skipped;
+  }
+
   // Creates a new object and populate it with trace information.
   // Subsequent calls to populateNewInstr() will take care of creating multiple pieces for a trace instruction
   // that has several outputs or 128-bit output.
@@ -312,7 +352,12 @@ struct CVPTraceReader
   db_t *populateNewInstr()
   {
      db_t * inst = new db_t();
+     populateInstr(inst);
+     return inst;
+  }
 
+  void populateInstr(db_t * inst)
+  {
      inst->insn = mInstr.mType;
      inst->pc = mInstr.mPc;
      inst->next_pc = mInstr.mTarget;
@@ -395,8 +440,13 @@ struct CVPTraceReader
        mCrackValIdx++;
        mCrackRegIdx++;
      }
+  }
 
-     return inst;
+  // Read bytes from the trace, keeping track of the offset in the uncompressed trace.
+  void readBytes(void * dst, uint64_t n)
+  {
+    dpressed_input->read((char*) dst, n);
+    nBytes += dpressed_input->gcount();
   }
 
   // Read bytes from the trace and populate a buffer object.
@@ -422,7 +472,7 @@ struct CVPTraceReader
     //   If SIMD (32 to 63)		- 16 bytes each
     mInstr.reset();
     start_fp_reg = 0;
-    dpressed_input->read((char*) &mInstr.mPc, sizeof(mInstr.mPc));
+    readBytes(&mInstr.mPc, sizeof(mInstr.mPc));
 
     if(dpressed_input->eof())
       return false;
@@ -433,50 +483,50 @@ struct CVPTraceReader
     mCrackValIdx = 0;
 
     mInstr.mTarget = mInstr.mPc + 4;
-    dpressed_input->read((char*) &mInstr.mType, sizeof(mInstr.mType));
+    readBytes(&mInstr.mType, sizeof(mInstr.mType));
 
     assert(mInstr.mType != undefInstClass);
 
     if(mInstr.mType == InstClass::loadInstClass || mInstr.mType == InstClass::storeInstClass)
     {
-      dpressed_input->read((char*) &mInstr.mEffAddr, sizeof(mInstr.mEffAddr));
-      dpressed_input->read((char*) &mInstr.mMemSize, sizeof(mInstr.mMemSize));
+      readBytes(&mInstr.mEffAddr, sizeof(mInstr.mEffAddr));
+      readBytes(&mInstr.mMemSize, sizeof(mInstr.mMemSize));
     }
     if(mInstr.mType == InstClass::condBranchInstClass || mInstr.mType == InstClass::uncondDirectBranchInstClass || mInstr.mType == InstClass::uncondIndirectBranchInstClass)
     {
-      dpressed_input->read((char*) &mInstr.mTaken, sizeof(mInstr.mTaken));
+      readBytes(&mInstr.mTaken, sizeof(mInstr.mTaken));
       if(mInstr.mTaken)
-        dpressed_input->read((char*) &mInstr.mTarget, sizeof(mInstr.mTarget));
+        readBytes(&mInstr.mTarget, sizeof(mInstr.mTarget));
     }
 
-    dpressed_input->read((char*) &mInstr.mNumInRegs, sizeof(mInstr.mNumInRegs));
+    readBytes(&mInstr.mNumInRegs, sizeof(mInstr.mNumInRegs));
 
     for(auto i = 0; i != mInstr.mNumInRegs; i++)
     {
       uint8_t inReg;
-      dpressed_input->read((char*) &inReg, sizeof(inReg));
+      readBytes(&inReg, sizeof(inReg));
       mInstr.mInRegs.push_back(inReg);
     }
 
-    dpressed_input->read((char*) &mInstr.mNumOutRegs, sizeof(mInstr.mNumOutRegs));
+    readBytes(&mInstr.mNumOutRegs, sizeof(mInstr.mNumOutRegs));
 
     mRemainingPieces = std::max(mRemainingPieces, mInstr.mNumOutRegs);
 
     for(auto i = 0; i != mInstr.mNumOutRegs; i++)
     {
       uint8_t outReg;
-      dpressed_input->read((char*) &outReg, sizeof(outReg));
+      readBytes(&outReg, sizeof(outReg));
       mInstr.mOutRegs.push_back(outReg);
     }
 
     for(auto i = 0; i != mInstr.mNumOutRegs; i++)
     {
       uint64_t val;
-      dpressed_input->read((char*) &val, sizeof(val));
+      readBytes(&val, sizeof(val));
       mInstr.mOutRegsValues.push_back(val);
       if(mInstr.mOutRegs[i] >= Offset::vecOffset && mInstr.mOutRegs[i] != Offset::ccOffset)
       {
-        dpressed_input->read((char*) &val, sizeof(val));
+        readBytes(&val, sizeof(val));
         mInstr.mOutRegsValues.push_back(val);
         if(val != 0)
           mRemainingPieces++;
@@ -36,10 +36,13 @@ public:
 	~fifo_t();
 	bool empty();		// returns true if empty, false otherwise
 	bool full();		// returns true if full, false otherwise
+	uint64_t footprint() const { return(size * sizeof(T)); }	// host memory of the entries, in bytes
 	T pop();		// pop and return head entry
 	void push(T value);	// push value at tail entry
 	T peektail();		// examine value at tail entry
 	T peekhead();		// examine value at head entry
+	uint64_t get_length() { return(length); }	// number of entries
+	T &at(uint64_t i);	// i-th entry from the head (0: head entry)
 };
 
 template <class T>
@@ -103,3 +106,10 @@ template <class T>
 T fifo_t<T>::peekhead() {
    return(q[head]);
 }
+
+// i-th entry from the head
+template <class T>
+T &fifo_t<T>::at(uint64_t i) {
+   assert(i < length);
+   return(q[(head + i) % size]);
+}
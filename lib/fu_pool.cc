@@ -0,0 +1,222 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include "fu_pool.h"
+
+fu_calendar_t::fu_calendar_t(uint64_t width) {
+   assert(width > 0);
+   this->width = width;
+   depth = FU_CALENDAR_DEPTH;
+   slots = new fu_slot_t[depth];
+   memset(slots, 0, (depth * sizeof(fu_slot_t)));
+   floor = 0;
+}
+
+fu_calendar_t::~fu_calendar_t() {
+   delete [] slots;
+}
+
+// Double the ring, keeping the live cycles.
+void fu_calendar_t::grow() {
+   fu_slot_t *old = slots;
+   uint64_t old_depth = depth;
+
+   depth = (depth << 1);
+   slots = new fu_slot_t[depth];
+   memset(slots, 0, (depth * sizeof(fu_slot_t)));
+   for (uint64_t i = 0; i < old_depth; i++) {
+      if (old[i].busy && (old[i].cycle >= floor))
+         slots[old[i].cycle & (depth - 1)] = old[i];
+   }
+   delete [] old;
+}
+
+fu_slot_t *fu_calendar_t::slot(uint64_t cycle) {
+   while (true) {
+      fu_slot_t *s = &slots[cycle & (depth - 1)];
+      if (s->cycle == cycle)
+         return(s);
+      if (!s->busy || (s->cycle < floor)) {
+         // Free: claim it.
+         s->cycle = cycle;
+         s->skip = (cycle + 1);
+         s->busy = 0;
+         return(s);
+      }
+      grow();
+   }
+}
+
+uint64_t fu_calendar_t::find(uint64_t cycle) {
+   uint64_t free_cycle = cycle;
+   while (true) {
+      fu_slot_t *s = slot(free_cycle);
+      if (s->busy < width)
+         break;
+      free_cycle = s->skip;
+   }
+
+   // Path compression: every full cycle on the way now points at the free one.
+   while (cycle != free_cycle) {
+      fu_slot_t *s = slot(cycle);
+      uint64_t next = s->skip;
+      s->skip = free_cycle;
+      cycle = next;
+   }
+   return(free_cycle);
+}
+
+uint64_t fu_calendar_t::schedule(uint64_t ready_cycle, uint64_t interval, uint64_t floor) {
+   assert((floor >= this->floor) && (ready_cycle >= floor));
+   this->floor = floor;
+
+   // The unit must be free for "interval" consecutive cycles.
+   uint64_t issue_cycle = find(ready_cycle);
+   for (uint64_t k = 1; k < interval; k++) {
+      if (slot(issue_cycle + k)->busy >= width) {
+         issue_cycle = find(issue_cycle + k + 1);
+         k = 0;
+      }
+   }
+
+   for (uint64_t k = 0; k < interval; k++)
+      slot(issue_cycle + k)->busy++;
+   return(issue_cycle);
+}
+
+static int class_of_letter(char c) {
+   switch (c) {
+      case 'a': return(0);	// aluInstClass
+      case 'b': return(3);	// condBranchInstClass
+      case 'j': return(4);	// uncondDirectBranchInstClass
+      case 'i': return(5);	// uncondIndirectBranchInstClass
+      case 'f': return(6);	// fpInstClass
+      case 's': return(7);	// slowAluInstClass
+      default: return(-1);
+   }
+}
+
+fu_pools_t::fu_pools_t(const char *description) {
+   for (int i = 0; i < FU_NUM_CLASSES; i++)
+      pool_of[i] = -1;
+
+   std::string desc(description);
+   size_t start = 0;
+   while (start <= desc.size()) {
+      size_t end = desc.find(',', start);
+      if (end == std::string::npos)
+         end = desc.size();
+      std::string item = desc.substr(start, (end - start));
+      start = (end + 1);
+
+      char name[64];
+      char classes[16];
+      unsigned long width, latency, interval = 1;
+      int n = sscanf(item.c_str(), "%63[^=]=%15[a-z]:%lu:%lu:%lu", name, classes, &width, &latency, &interval);
+      if ((n < 4) || (latency == 0) || (interval == 0) || (pools.size() == FU_MAX_POOLS)) {
+         printf("Error: functional-unit pool \"%s\": expected <name>=<classes>:<width>:<latency>[:<interval>] (latency, interval >= 1).\n", item.c_str());
+         exit(1);
+      }
+      for (const char *c = classes; *c; c++) {
+         int insn = class_of_letter(*c);
+         if (insn < 0) {
+            printf("Error: functional-unit pool \"%s\": unknown class '%c' (a, b, j, i, f, s).\n", item.c_str(), *c);
+            exit(1);
+         }
+         if (pool_of[insn] >= 0) {
+            printf("Error: functional-unit pool \"%s\": class '%c' is already in pool \"%s\".\n", item.c_str(), *c, pools[pool_of[insn]].name.c_str());
+            exit(1);
+         }
+         pool_of[insn] = (int)pools.size();
+      }
+
+      fu_pool_t p;
+      p.name = name;
+      p.classes = classes;
+      p.width = width;
+      p.latency = latency;
+      p.interval = interval;
+      p.calendar = (width ? (new fu_calendar_t(width)) : ((fu_calendar_t *)NULL));
+      memset(&p.stats, 0, sizeof(p.stats));
+      pools.push_back(p);
+   }
+}
+
+fu_pools_t::~fu_pools_t() {
+   for (uint64_t i = 0; i < pools.size(); i++) {
+      if (pools[i].calendar)
+         delete pools[i].calendar;
+   }
+}
+
+void fu_pools_t::reset_stats() {
+   for (uint64_t i = 0; i < pools.size(); i++)
+      memset(&pools[i].stats, 0, sizeof(fu_pool_stats_t));
+}
+
+void fu_pools_t::get_stats(fu_pool_stats_t *s) const {
+   memset(s, 0, (FU_MAX_POOLS * sizeof(fu_pool_stats_t)));
+   for (uint64_t i = 0; i < pools.size(); i++)
+      s[i] = pools[i].stats;
+}
+
+void fu_pools_t::add_stats(const fu_pool_stats_t *s) {
+   for (uint64_t i = 0; i < pools.size(); i++) {
+      pools[i].stats.ops += s[i].ops;
+      pools[i].stats.wait += s[i].wait;
+   }
+}
+
+void fu_pools_t::print_config() {
+   for (uint64_t i = 0; i < pools.size(); i++) {
+      printf("FU_POOL %s = classes %s, ", pools[i].name.c_str(), pools[i].classes.c_str());
+      if (pools[i].width)
+         printf("%lu unit%s", pools[i].width, ((pools[i].width > 1) ? "s" : ""));
+      else
+         printf("unbounded");
+      printf(", %lu-cycle latency, issue interval %lu\n", pools[i].latency, pools[i].interval);
+   }
+}
+
+void fu_pools_t::output() {
+   printf("FUNCTIONAL UNIT POOLS------------------------------\n");
+   printf("Pool                 ops    avg wait\n");
+   for (uint64_t i = 0; i < pools.size(); i++)
+      printf("%-12s %11lu %11.3f\n", pools[i].name.c_str(), pools[i].stats.ops,
+             (pools[i].stats.ops ? ((double)pools[i].stats.wait/(double)pools[i].stats.ops) : 0.0));
+}
+
+uint64_t fu_pools_t::footprint() const {
+   uint64_t bytes = 0;
+   for (uint64_t i = 0; i < pools.size(); i++)
+      bytes += (sizeof(fu_pool_t) + (pools[i].calendar ? pools[i].calendar->footprint() : 0));
+   return(bytes);
+}
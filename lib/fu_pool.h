@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _FU_POOL_H_
+#define _FU_POOL_H_
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+// Functional-unit pools: instruction classes are mapped to pools of identical units, each
+// with a width (number of units), an execution latency and an issue interval (cycles before
+// a unit accepts another instruction: 1 if pipelined, typically the latency if not).
+//
+// A pool is described as "<name>=<classes>:<width>:<latency>[:<interval>]" and pools are
+// separated by commas, e.g. "int=abji:4:1,fp=f:2:3,muldiv=s:1:12:12" for a non-pipelined
+// multiply/divide unit. A class belongs to at most one pool. Classes:
+//
+//    a  ALU			f  FP/SIMD
+//    b  conditional branch	s  slow ALU (multiply/divide)
+//    j  direct jump/call	i  indirect jump/return
+//
+// Width 0 means unbounded. Loads and stores keep the load/store lanes (-M) and the memory
+// pipeline; classes not in any pool keep the ALU lanes (-A) and the fixed latencies.
+
+#define FU_MAX_POOLS		6	// one per non-memory instruction class at most
+#define FU_NUM_CLASSES		8	// InstClass values, undefInstClass excluded
+#define FU_CALENDAR_DEPTH	256	// initial cycles in a calendar; a power of 2
+
+// Calendar of a pool: the number of busy units in each cycle, in a ring of slots tagged with
+// their cycle. Slots of cycles before the floor (no instruction is scheduled before it any
+// more) are free for reuse, so advancing time costs nothing, and the ring doubles when two
+// live cycles collide. Each full cycle points to a later cycle that may have a free unit;
+// with path compression, finding the first free cycle is O(1) amortized even when many
+// instructions queue up for a narrow pool.
+struct fu_slot_t {
+   uint64_t cycle;	// cycle held by the slot
+   uint64_t skip;	// if the cycle is full: a later cycle that may have a free unit
+   uint64_t busy;	// busy units in the cycle
+};
+
+class fu_calendar_t {
+private:
+   fu_slot_t *slots;
+   uint64_t depth;
+   uint64_t width;
+   uint64_t floor;
+
+   fu_slot_t *slot(uint64_t cycle);	// grows the ring if another live cycle holds the slot
+   void grow();
+   uint64_t find(uint64_t cycle);	// first cycle at or after "cycle" with a free unit
+
+public:
+   fu_calendar_t(uint64_t width);
+   ~fu_calendar_t();
+
+   // Reserve a unit for "interval" cycles from the earliest cycle at or after "ready_cycle"
+   // when one is free throughout; returns that cycle. "floor" never decreases between calls
+   // and no call asks for a cycle before it.
+   uint64_t schedule(uint64_t ready_cycle, uint64_t interval, uint64_t floor);
+
+   uint64_t footprint() const { return(depth * sizeof(fu_slot_t)); }	// host memory, in bytes
+};
+
+struct fu_pool_stats_t {
+   uint64_t ops;	// instructions executed by the pool
+   uint64_t wait;	// cycles instructions waited for a unit after their operands were ready
+};
+
+struct fu_pool_t {
+   std::string name;
+   std::string classes;
+   uint64_t width;
+   uint64_t latency;
+   uint64_t interval;
+   fu_calendar_t *calendar;	// NULL: unbounded
+   fu_pool_stats_t stats;
+};
+
+class fu_pools_t {
+private:
+   std::vector<fu_pool_t> pools;
+   int pool_of[FU_NUM_CLASSES];	// pool of each instruction class; -1: none
+
+public:
+   fu_pools_t(const char *description);	// exits with an error message on a malformed description
+   ~fu_pools_t();
+
+   // Pool of an instruction class; NULL: the class is not in any pool.
+   inline fu_pool_t *get(uint8_t insn) {
+      return(((insn < FU_NUM_CLASSES) && (pool_of[insn] >= 0)) ? &pools[pool_of[insn]] : (fu_pool_t *)NULL);
+   }
+
+   // Issue cycle of an instruction whose operands are ready at "ready_cycle".
+   inline uint64_t schedule(fu_pool_t *p, uint64_t ready_cycle, uint64_t floor) {
+      uint64_t issue_cycle = (p->calendar ? p->calendar->schedule(ready_cycle, p->interval, floor) : ready_cycle);
+      p->stats.ops++;
+      p->stats.wait += (issue_cycle - ready_cycle);
+      return(issue_cycle);
+   }
+
+   void reset_stats();
+   void get_stats(fu_pool_stats_t *s) const;	// FU_MAX_POOLS entries
+   void add_stats(const fu_pool_stats_t *s);
+
+   void print_config();
+   void output();
+   uint64_t footprint() const;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <math.h>
+#include "interval_stats.h"
+
+#define RATIO(n, d)	(((d) > 0) ? ((double)(n)/(double)(d)) : 0.0)
+
+interval_writer_t::interval_writer_t(const char *filename) {
+   uint64_t n = strlen(filename);
+   binary = ((n >= 4) && !strcmp(filename + n - 4, ".bin"));
+
+   fp = fopen(filename, (binary ? "wb" : "w"));
+   if (!fp) {
+      printf("Error: could not open interval statistics file %s.\n", filename);
+      exit(1);
+   }
+
+   buf = new char[INTERVAL_BUFSIZE];
+   len = 0;
+   reset();
+
+   if (binary) {
+      uint64_t num_fields = sizeof(interval_record_t)/sizeof(uint64_t);
+      memcpy(buf, "CVPIVL1", 8);
+      memcpy(buf + 8, &num_fields, sizeof(num_fields));
+      len = 16;
+   }
+   else {
+      len = snprintf(buf, INTERVAL_BUFSIZE, "inst,cycle,ipc,interval_ipc,branch_mpki,l1_miss_ratio,l2_miss_ratio,l3_miss_ratio,pf_issued,vp_correct,vp_incorrect\n");
+   }
+}
+
+interval_writer_t::~interval_writer_t() {
+   close();
+}
+
+void interval_writer_t::reset() {
+   memset(&prev, 0, sizeof(prev));
+}
+
+void interval_writer_t::flush() {
+   if (fp && len) {
+      fwrite(buf, 1, len, fp);
+      len = 0;
+   }
+}
+
+void interval_writer_t::sample(const interval_counters_t &now) {
+   interval_record_t r;
+   uint64_t inst = (now.inst - prev.inst);
+
+   r.inst = now.inst;
+   r.cycle = now.cycle;
+   r.ipc = RATIO(now.inst, now.cycle);
+   r.interval_ipc = RATIO(inst, (now.cycle - prev.cycle));
+   r.branch_mpki = 1000.0*RATIO((now.bp_misp - prev.bp_misp), (now.bp_inst - prev.bp_inst));
+   r.l1_miss_ratio = RATIO((now.l1_misses - prev.l1_misses), (now.l1_accesses - prev.l1_accesses));
+   r.l2_miss_ratio = RATIO((now.l2_misses - prev.l2_misses), (now.l2_accesses - prev.l2_accesses));
+   r.l3_miss_ratio = RATIO((now.l3_misses - prev.l3_misses), (now.l3_accesses - prev.l3_accesses));
+   r.pf_issued = (now.pf_issued - prev.pf_issued);
+   r.vp_correct = (now.vp_correct - prev.vp_correct);
+   r.vp_incorrect = (now.vp_incorrect - prev.vp_incorrect);
+   prev = now;
+
+   // Keep room for the largest record.
+   if ((INTERVAL_BUFSIZE - len) < 512)
+      flush();
+
+   if (binary) {
+      memcpy(buf + len, &r, sizeof(r));
+      len += sizeof(r);
+   }
+   else {
+      len += snprintf(buf + len, (INTERVAL_BUFSIZE - len), "%lu,%lu,%.4f,%.4f,%.4f,%.6f,%.6f,%.6f,%lu,%lu,%lu\n",
+                      r.inst, r.cycle, r.ipc, r.interval_ipc, r.branch_mpki,
+                      r.l1_miss_ratio, r.l2_miss_ratio, r.l3_miss_ratio,
+                      r.pf_issued, r.vp_correct, r.vp_incorrect);
+   }
+}
+
+void interval_writer_t::close() {
+   if (fp) {
+      flush();
+      fclose(fp);
+      fp = NULL;
+   }
+   if (buf) {
+      delete [] buf;
+      buf = NULL;
+   }
+}
+
+
+static const char *convergence_metric_names[CONV_NUM_METRICS] = {
+   "IPC",
+   "Branch MPKI",
+   "VP coverage",
+};
+
+convergence_t::convergence_t(double rel_err, const char *metrics) {
+   this->rel_err = rel_err;
+   assert(strspn(metrics, CONV_METRIC_LETTERS) == strlen(metrics));
+   for (int i = 0; i < CONV_NUM_METRICS; i++)
+      tracked[i] = (strchr(metrics, CONV_METRIC_LETTERS[i]) != NULL);
+   tracked[CONV_IPC] = true;
+   reset();
+}
+
+void convergence_t::reset() {
+   memset(&prev, 0, sizeof(prev));
+   n = 0;
+   for (int i = 0; i < CONV_NUM_METRICS; i++) {
+      mean[i] = 0.0;
+      m2[i] = 0.0;
+   }
+   done = false;
+}
+
+// 95% confidence interval half-width of the mean (Student's t for few intervals).
+double convergence_t::half_width(int metric) const {
+   static const double t95[] = { 0.0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+                                 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093,
+                                 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045 };
+   if (n < 2)
+      return(INFINITY);
+   uint64_t dof = (n - 1);
+   double t = ((dof < (sizeof(t95)/sizeof(t95[0]))) ? t95[dof] : 1.960);
+   return(t * sqrt(m2[metric]/(double)(n - 1)) / sqrt((double)n));
+}
+
+void convergence_t::sample(const interval_counters_t &now) {
+   double x[CONV_NUM_METRICS];
+   uint64_t inst = (now.inst - prev.inst);
+   x[CONV_IPC] = RATIO(inst, (now.cycle - prev.cycle));
+   x[CONV_MPKI] = 1000.0*RATIO((now.bp_misp - prev.bp_misp), (now.bp_inst - prev.bp_inst));
+   x[CONV_VP_COVERAGE] = RATIO((now.vp_correct - prev.vp_correct), inst);
+   prev = now;
+
+   n++;
+   for (int i = 0; i < CONV_NUM_METRICS; i++) {
+      double delta = (x[i] - mean[i]);
+      mean[i] += (delta/(double)n);
+      m2[i] += (delta * (x[i] - mean[i]));
+   }
+
+   if (n < CONVERGENCE_MIN_INTERVALS)
+      return;
+   done = true;
+   for (int i = 0; i < CONV_NUM_METRICS; i++) {
+      // A metric that is constantly zero (e.g., no mispredictions) has converged.
+      if (tracked[i] && !((m2[i] == 0.0) || (half_width(i) < (rel_err * fabs(mean[i])))))
+         done = false;
+   }
+}
+
+void convergence_t::output() {
+   printf("Intervals: %lu, target relative error: %.2f%% (95%% confidence)\n", n, 100.0*rel_err);
+   printf("Metric               mean    +/-   rel. err\n");
+   for (int i = 0; i < CONV_NUM_METRICS; i++) {
+      if (tracked[i]) {
+         double h = half_width(i);
+         printf("%-14s %10.4f %8.4f %8.2f%%\n", convergence_metric_names[i], mean[i], h,
+                ((mean[i] != 0.0) ? (100.0*h/fabs(mean[i])) : 0.0));
+      }
+   }
+}
@@ -0,0 +1,138 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _INTERVAL_STATS_H_
+#define _INTERVAL_STATS_H_
+
+#include <stdio.h>
+
+// Raw counters sampled at the end of each interval.
+// Interval measurements are differences between consecutive samples.
+struct interval_counters_t {
+   uint64_t inst;
+   uint64_t cycle;
+   uint64_t bp_inst;
+   uint64_t bp_misp;
+   uint64_t l1_accesses, l1_misses;
+   uint64_t l2_accesses, l2_misses;
+   uint64_t l3_accesses, l3_misses;
+   uint64_t pf_issued;
+   uint64_t vp_correct;
+   uint64_t vp_incorrect;
+};
+
+// One time-series record. Ratios are per interval unless noted.
+// The binary format is a header ("CVPIVL1" and the number of fields) followed by raw records.
+struct interval_record_t {
+   uint64_t inst;		// cumulative measured instructions
+   uint64_t cycle;		// cumulative measured cycles
+   double ipc;			// cumulative IPC
+   double interval_ipc;
+   double branch_mpki;
+   double l1_miss_ratio;
+   double l2_miss_ratio;
+   double l3_miss_ratio;
+   uint64_t pf_issued;
+   uint64_t vp_correct;
+   uint64_t vp_incorrect;
+};
+
+#define INTERVAL_BUFSIZE	(1 << 20)
+
+// Buffered writer: records accumulate in memory and reach the file in large writes.
+class interval_writer_t {
+private:
+   FILE *fp;
+   bool binary;
+   char *buf;
+   uint64_t len;
+
+   interval_counters_t prev;
+
+   void flush();
+
+public:
+   // Files ending in ".bin" are written in binary, all others as CSV.
+   interval_writer_t(const char *filename);
+   ~interval_writer_t();
+
+   // Emit a record for the interval ending at "now".
+   void sample(const interval_counters_t &now);
+
+   // Restart interval measurements from zero (e.g., after warm-up).
+   void reset();
+
+   void close();
+};
+
+// Confidence-driven early termination.
+//
+// Per-interval IPC (and optionally branch MPKI and value prediction coverage) are
+// treated as batch means: after each interval, the 95% confidence interval of each
+// tracked metric's mean is updated, and the run has converged once every half-width,
+// relative to its mean, is below the threshold. Intervals should be long enough
+// (e.g., 1M instructions) for consecutive intervals to be roughly independent.
+
+#define CONVERGENCE_MIN_INTERVALS	10	// never stop on fewer intervals
+
+enum convergence_metric_t {
+   CONV_IPC = 0,
+   CONV_MPKI,		// branch mispredictions per 1000 instructions
+   CONV_VP_COVERAGE,	// correct value predictions per instruction
+   CONV_NUM_METRICS
+};
+
+#define CONV_METRIC_LETTERS	"imv"	// letter selecting each metric (-E), in convergence_metric_t order
+
+class convergence_t {
+private:
+   double rel_err;
+   bool tracked[CONV_NUM_METRICS];
+
+   interval_counters_t prev;
+
+   // Running mean and sum of squared deviations (Welford) per metric.
+   uint64_t n;
+   double mean[CONV_NUM_METRICS];
+   double m2[CONV_NUM_METRICS];
+
+   bool done;
+
+   double half_width(int metric) const;
+
+public:
+   // "metrics" selects the tracked metrics (CONV_METRIC_LETTERS): 'i' (IPC), 'm' (branch MPKI),
+   // 'v' (VP coverage). IPC is always tracked.
+   convergence_t(double rel_err, const char *metrics);
+
+   // Add the interval ending at "now".
+   void sample(const interval_counters_t &now);
+
+   // Restart from zero (e.g., after warm-up).
+   void reset();
+
+   bool converged() const { return(done); }
+   void output();
+};
+
+#endif
@@ -101,7 +101,19 @@ public:
   int Seed;    // for the pseudo-random number generator
   uint64_t target_inter;
 
-  IPREDICTOR(void) { reinit(); }
+  IPREDICTOR(void) {
+    memset((void *)this, 0, sizeof(*this)); // as for PREDICTOR: reinit() leaves histories unset
+    reinit();
+  }
+  ~IPREDICTOR(void) {
+    for (int i = 0; i <= NHIST; i++)
+      arena_delete(itable[i], (1 << LOGG), ARENA_HOT);
+  }
+
+  // Host memory of the predictor (this object and the tables it allocates), in bytes.
+  uint64_t footprint() const {
+    return sizeof(*this) + ((uint64_t)(NHIST + 1) * (1 << LOGG) * sizeof(ientry));
+  }
 
   void reinit() {
     m[0] = 0;
@@ -119,7 +131,7 @@ public:
     }
 
     for (int i = 0; i <= NHIST; i++)
-      itable[i] = new ientry[(1 << LOGG)];
+      itable[i] = arena_new<ientry>((1 << LOGG), ARENA_HOT);
 
     for (int i = 0; i <= NHIST; i++) {
       ch_i[i].init(m[i], (logg[i]));
@@ -0,0 +1,83 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <atomic>
+#include "live_stats.h"
+
+#define RATIO(n, d)	(((d) > 0) ? ((double)(n)/(double)(d)) : 0.0)
+
+live_stats_t::live_stats_t(const char *filename) {
+   int fd = open(filename, (O_RDWR | O_CREAT | O_TRUNC), 0644);
+   if ((fd < 0) || (ftruncate(fd, sizeof(live_counters_t)) != 0)) {
+      printf("Error: could not create live statistics file %s.\n", filename);
+      exit(1);
+   }
+   void *p = mmap(NULL, sizeof(live_counters_t), (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+   close(fd);
+   if (p == MAP_FAILED) {
+      printf("Error: could not map live statistics file %s.\n", filename);
+      exit(1);
+   }
+
+   page = (volatile live_counters_t *)p;
+   memset(p, 0, sizeof(live_counters_t));
+   memcpy(p, LIVE_STATS_MAGIC, 8);
+   page->pid = (uint64_t)getpid();
+   page->update_time = (uint64_t)time(NULL);
+}
+
+live_stats_t::~live_stats_t() {
+   munmap((void *)page, sizeof(live_counters_t));
+}
+
+void live_stats_t::update(live_state_t state, uint64_t simulated, const interval_counters_t &c) {
+   page->seq++;		// odd: update in progress
+   std::atomic_thread_fence(std::memory_order_release);
+
+   page->state = state;
+   page->update_time = (uint64_t)time(NULL);
+   page->simulated = simulated;
+   page->inst = c.inst;
+   page->cycle = c.cycle;
+   page->ipc = RATIO(c.inst, c.cycle);
+   page->branch_mpki = 1000.0*RATIO(c.bp_misp, c.bp_inst);
+   page->l1_miss_ratio = RATIO(c.l1_misses, c.l1_accesses);
+   page->l2_miss_ratio = RATIO(c.l2_misses, c.l2_accesses);
+   page->l3_miss_ratio = RATIO(c.l3_misses, c.l3_accesses);
+   page->vp_accuracy = RATIO(c.vp_correct, (c.vp_correct + c.vp_incorrect));
+   page->vp_coverage = RATIO(c.vp_correct, c.inst);
+
+   std::atomic_thread_fence(std::memory_order_release);
+   page->seq++;		// even: consistent
+}
@@ -0,0 +1,76 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _LIVE_STATS_H_
+#define _LIVE_STATS_H_
+
+#include "interval_stats.h"
+
+// Live counters page: key measurements mirrored into a memory-mapped file while the
+// simulation runs, so that monitoring scripts can poll many jobs by reading a small file.
+//
+// The file holds one live_counters_t (native byte order), refreshed every
+// LIVE_STATS_PERIOD simulated instructions and at the end of the run. Updates use a
+// sequence lock: "seq" is odd while an update is in progress. A reader copies the
+// record and accepts it if "seq" is even and unchanged before and after the copy.
+
+#define LIVE_STATS_MAGIC	"CVPLIVE1"
+#define LIVE_STATS_PERIOD	(1 << 16)	// instructions; must be a power of 2
+
+enum live_state_t {
+   LIVE_WARMUP = 0,	// simulating warm-up instructions
+   LIVE_MEASURING,
+   LIVE_FINISHED
+};
+
+struct live_counters_t {
+   char magic[8];		// LIVE_STATS_MAGIC
+   uint64_t seq;		// sequence lock
+   uint64_t pid;
+   uint64_t state;		// live_state_t
+   uint64_t update_time;	// seconds since the epoch
+   uint64_t simulated;		// simulated instructions, including warm-up
+   uint64_t inst;		// measured instructions
+   uint64_t cycle;		// measured cycles
+   double ipc;
+   double branch_mpki;
+   double l1_miss_ratio;
+   double l2_miss_ratio;
+   double l3_miss_ratio;
+   double vp_accuracy;		// correct/(correct + incorrect) value predictions
+   double vp_coverage;		// correct value predictions per measured instruction
+};
+
+class live_stats_t {
+private:
+   volatile live_counters_t *page;
+
+public:
+   live_stats_t(const char *filename);
+   ~live_stats_t();
+
+   void update(live_state_t state, uint64_t simulated, const interval_counters_t &c);
+};
+
+#endif
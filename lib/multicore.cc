@@ -0,0 +1,305 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <signal.h>
+#include <thread>
+#include "cvp.h"
+#include "cvp_trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "arena.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "trace_index.h"
+#include "multicore.h"
+
+
+/////////////////////////////
+// Port to the shared L3.
+/////////////////////////////
+
+shared_cache_port_t::shared_cache_port_t(cache_t *llc, uint64_t core) {
+   assert(core < (1ULL << (64 - CORE_ADDR_SHIFT)));
+   this->llc = llc;
+   this->core = core;
+   copy = new cache_t(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL, L3_REPL, L3_MSHRS, ARENA_COLD);
+   copy->sync(*llc);
+}
+
+shared_cache_port_t::~shared_cache_port_t() {
+   delete copy;
+}
+
+void shared_cache_port_t::touch(uint64_t addr) {
+   if (copied.insert(copy->set_of(addr)).second)
+      copy->copy_set(*llc, addr);
+}
+
+uint64_t shared_cache_port_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf, uint64_t *level) {
+   llc_request_t r = {cycle, llc_addr(addr), read, pf, false, mem_access_timing_t()};
+
+   touch(r.addr);
+   copy->record(&r.mem);
+   uint64_t avail = copy->access(cycle, read, r.addr, pf, level);
+   copy->record((mem_access_timing_t *)NULL);
+   requests.push_back(r);
+   return(avail);
+}
+
+void shared_cache_port_t::write_back(uint64_t cycle, uint64_t addr) {
+   llc_request_t r = {cycle, llc_addr(addr), false, false, true, mem_access_timing_t()};
+
+   touch(r.addr);
+   copy->record(&r.mem);
+   copy->write_back(cycle, r.addr);
+   copy->record((mem_access_timing_t *)NULL);
+   requests.push_back(r);
+}
+
+bool shared_cache_port_t::is_hit(uint64_t cycle, uint64_t addr) const {
+   addr = llc_addr(addr);
+   if (copied.count(copy->set_of(addr)))
+      return(copy->is_hit(cycle, addr));
+   return(llc->is_hit(cycle, addr));
+}
+
+void shared_cache_port_t::end_quantum() {
+   requests.clear();
+   copied.clear();
+   copy->sync(*llc);
+}
+
+
+/////////////////////////////
+// Multi-core driver.
+/////////////////////////////
+
+multicore_t::multicore_t(uint64_t num_cores, char **trace_names, uint64_t quantum) {
+   assert(num_cores > 0);
+   assert(quantum > 0);
+
+   llc = new cache_t(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL, L3_REPL, L3_MSHRS, ARENA_COLD);
+   cores.resize(num_cores);
+   for (uint64_t i = 0; i < num_cores; i++) {
+      core_t &c = cores[i];
+      c.trace_name = trace_names[i];
+      c.reader = new CVPTraceReader(c.trace_name);
+      if (SKIP_INSTS)
+         trace_fast_forward(*c.reader, c.trace_name, SKIP_INSTS);
+      c.port = new shared_cache_port_t(llc, i);
+      c.sim = new uarchsim_t(c.port);
+      c.num_sim = 0;
+      c.done = false;
+   }
+
+   this->quantum = quantum;
+   quantum_end = quantum;
+   num_quanta = 0;
+   llc_stats_reset = (WARMUP_INSTS == 0);
+   all_done = false;
+   arrived = 0;
+   generation = 0;
+}
+
+multicore_t::~multicore_t() {
+   for (uint64_t i = 0; i < cores.size(); i++) {
+      delete cores[i].sim;
+      delete cores[i].port;
+      if (cores[i].reader)
+         delete cores[i].reader;
+   }
+   delete llc;
+}
+
+uint64_t multicore_t::footprint() const {
+   uint64_t bytes = llc->footprint();
+   for (uint64_t i = 0; i < cores.size(); i++)
+      bytes += ((2 * cores[i].sim->footprint(false)) + cores[i].port->footprint());
+   return(bytes);
+}
+
+void multicore_t::run_quantum(core_t &c) {
+   while (!c.done && (c.sim->get_fetch_cycle() < quantum_end)) {
+      if (!simulate_inst(c.reader, c.sim, c.num_sim))
+         c.done = true;
+   }
+}
+
+void multicore_t::end_quantum() {
+   // Apply this quantum's shared L3 requests. A core's requests are applied in the order it
+   // made them, which is the order a private L3 would see them in (an out-of-order core's
+   // request cycles are not monotonic). The cores' logs are merged by cycle, ties going to
+   // the lower-numbered core.
+   std::vector<uint64_t> next(cores.size(), 0);
+   while (true) {
+      uint64_t pick = cores.size();
+      for (uint64_t i = 0; i < cores.size(); i++) {
+         std::vector<llc_request_t> &r = cores[i].port->get_requests();
+         if ((next[i] < r.size()) && ((pick == cores.size()) || (r[next[i]].cycle < cores[pick].port->get_requests()[next[pick]].cycle)))
+            pick = i;
+      }
+      if (pick == cores.size())
+         break;
+      llc_request_t &q = cores[pick].port->get_requests()[next[pick]++];
+      llc->replay(q.cycle, q.read, q.addr, q.pf, q.wb, q.mem);
+   }
+
+   // Prune the shared L3's timelines and rebase its timestamps: no core accesses it before its own stamp floor.
+   uint64_t floor = UINT64_MAX;
+   for (uint64_t i = 0; i < cores.size(); i++) {
+      if (!cores[i].done && (cores[i].sim->get_stamp_floor() < floor))
+         floor = cores[i].sim->get_stamp_floor();
+   }
+   if (floor != UINT64_MAX) {
+      llc->prune(floor);
+      if ((floor - llc->get_stamp_base()) >= STAMP_REBASE_DISTANCE)
+         llc->rebase(floor);
+   }
+   for (uint64_t i = 0; i < cores.size(); i++)
+      cores[i].port->end_quantum();
+
+   num_quanta++;
+   quantum_end += quantum;
+
+   all_done = true;
+   bool warm = true;
+   for (uint64_t i = 0; i < cores.size(); i++) {
+      all_done = (all_done && cores[i].done);
+      warm = (warm && (cores[i].done || (cores[i].num_sim >= WARMUP_INSTS)));
+   }
+
+   // Shared L3 measurements start when every core is past its warm-up.
+   if (!llc_stats_reset && warm) {
+      llc->reset_stats();
+      llc_stats_reset = true;
+   }
+
+   // Interim report (SIGUSR1): every core is stopped at the barrier.
+   if (!all_done && take_interim_report_request()) {
+      printf("INTERIM REPORT (%lu quanta)=====================================\n", num_quanta);
+      for (uint64_t i = 0; i < cores.size(); i++) {
+         printf("CORE %lu: %s (%lu instructions simulated)==================================\n", i, cores[i].trace_name, cores[i].num_sim);
+         cores[i].sim->output();
+      }
+      printf("END OF INTERIM REPORT=========================================================\n");
+      fflush(stdout);
+   }
+}
+
+void multicore_t::barrier() {
+   std::unique_lock<std::mutex> lock(mtx);
+   uint64_t gen = generation;
+   if (++arrived == cores.size()) {
+      end_quantum();
+      arrived = 0;
+      generation++;
+      cv.notify_all();
+   }
+   else {
+      cv.wait(lock, [&]{ return(generation != gen); });
+   }
+}
+
+void multicore_t::run_core(uint64_t i) {
+   while (true) {
+      run_quantum(cores[i]);
+      barrier();
+      if (all_done)	// set by end_quantum() before the barrier released this thread
+         break;
+   }
+
+   // Close the trace now: the reader reports the number of instructions it read.
+   delete cores[i].reader;
+   cores[i].reader = (CVPTraceReader *)NULL;
+}
+
+void multicore_t::run() {
+   // Core 0 runs on the calling thread.
+   std::vector<std::thread> threads;
+   for (uint64_t i = 1; i < cores.size(); i++)
+      threads.push_back(std::thread(&multicore_t::run_core, this, i));
+   run_core(0);
+   for (uint64_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+}
+
+// Baseline for weighted speedup: the trace running alone, on a core with a private L3.
+static void run_alone(const char *trace_name, double *ipc) {
+   CVPTraceReader reader(trace_name);
+   if (SKIP_INSTS)
+      trace_fast_forward(reader, trace_name, SKIP_INSTS);
+
+   uarchsim_t *sim = new uarchsim_t;
+   uint64_t num_sim = 0;
+   while (simulate_inst(&reader, sim, num_sim))
+      ;
+   *ipc = ((double)sim->get_measured_inst()/(double)sim->get_measured_cycles());
+   delete sim;
+}
+
+void multicore_t::output() {
+   // The alone runs are only a baseline: no interim reports from them.
+   signal(SIGUSR1, SIG_IGN);
+
+   std::vector<double> alone_ipc(cores.size());
+   std::vector<std::thread> threads;
+   for (uint64_t i = 0; i < cores.size(); i++)
+      threads.push_back(std::thread(run_alone, cores[i].trace_name, &alone_ipc[i]));
+   for (uint64_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+
+   for (uint64_t i = 0; i < cores.size(); i++) {
+      printf("CORE %lu: %s==================================\n", i, cores[i].trace_name);
+      cores[i].sim->output();
+   }
+
+   printf("MULTI-CORE-----------------------------------------\n");
+   printf("cores   = %lu\n", cores.size());
+   printf("quantum = %lu cycles (%lu quanta)\n", quantum, num_quanta);
+   printf("Shared L3$:\n"); llc->stats();
+   printf("Core  instructions         cycles    IPC  alone IPC  speedup\n");
+   double throughput = 0.0;
+   double weighted_speedup = 0.0;
+   for (uint64_t i = 0; i < cores.size(); i++) {
+      uint64_t inst = cores[i].sim->get_measured_inst();
+      uint64_t cycles = cores[i].sim->get_measured_cycles();
+      double ipc = ((double)inst/(double)cycles);
+      throughput += ipc;
+      weighted_speedup += (ipc/alone_ipc[i]);
+      printf("%4lu %13lu %14lu %6.3f %10.3f %8.3f\n", i, inst, cycles, ipc, alone_ipc[i], (ipc/alone_ipc[i]));
+   }
+   printf("Throughput (sum of IPCs) = %.3f\n", throughput);
+   printf("Weighted speedup         = %.3f\n", weighted_speedup);
+
+   // The cores share the L3 and main memory and nothing else, so none can beat running alone.
+   if (weighted_speedup > (double)cores.size())
+      printf("Warning: weighted speedup exceeds the number of cores (%lu).\n", cores.size());
+}
@@ -0,0 +1,152 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _MULTICORE_H_
+#define _MULTICORE_H_
+
+#include <vector>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+
+// Multi-core simulation: one core model per trace, each with private IC/L1/L2,
+// sharing one L3 and main memory.
+//
+// Every core runs on its own host thread for a quantum of Q cycles (of its own
+// fetch cycle), then all cores meet at a barrier. During a quantum the shared L3
+// is read-only: each core's L2 misses and writebacks access its own copy of the L3,
+// which starts the quantum as the shared L3 (contents, and MSHR and main memory bus
+// occupancy) and takes each set from it when the core first touches the set. The
+// requests are logged with the main memory timing the core decided. At the barrier,
+// the logged requests of all cores are applied to the shared L3 in cycle order (each
+// core's in its own order), reserving main memory as decided. Results therefore do not
+// depend on thread scheduling, a core alone sees exactly a private L3, and sharing
+// effects (capacity and main memory contention) become visible one quantum later.
+//
+// The traces are separate programs: each core's addresses carry its core id in their
+// high bits (CORE_ADDR_SHIFT and up) in the shared L3, so the cores never share blocks.
+
+#define CORE_ADDR_SHIFT 56
+#define CORE_ADDR_MASK ((1ULL << CORE_ADDR_SHIFT) - 1)
+
+#include "cache.h"
+
+struct cache_stats_t;
+class uarchsim_t;
+struct CVPTraceReader;
+
+struct llc_request_t {
+   uint64_t cycle;
+   uint64_t addr;
+   bool read;
+   bool pf;
+   bool wb;	// writeback of a dirty block evicted from the core's L2
+   mem_access_timing_t mem;	// main memory timing the core decided
+};
+
+// A core's port to the shared L3. Its measurements are this core's view of the L3 (its copy's).
+class shared_cache_port_t {
+private:
+   cache_t *llc;
+   cache_t *copy;				// this core's copy of the L3 during a quantum
+   uint64_t core;
+   std::vector<llc_request_t> requests;		// this quantum, in order
+   std::unordered_set<uint64_t> copied;		// sets of "copy" taken from the L3 this quantum
+
+   // Address of "addr" in the shared L3: tagged with this core's id.
+   uint64_t llc_addr(uint64_t addr) const { return((addr & CORE_ADDR_MASK) | (core << CORE_ADDR_SHIFT)); }
+   // Take the set of "addr" from the L3, the first time this quantum.
+   void touch(uint64_t addr);
+
+public:
+   shared_cache_port_t(cache_t *llc, uint64_t core);
+   ~shared_cache_port_t();
+
+   // Same interface as cache_t::access(); "level" receives 1 for an L3 hit and 2 for main memory.
+   uint64_t access(uint64_t cycle, bool read, uint64_t addr, bool pf = false, uint64_t *level = NULL);
+   bool is_hit(uint64_t cycle, uint64_t addr) const;
+   // Same as cache_t::write_back(), logged like the accesses.
+   void write_back(uint64_t cycle, uint64_t addr);
+
+   // Hand over the requests of the quantum that just ended. Once they are applied to the L3,
+   // forget them, and start the next quantum's copy of the L3.
+   std::vector<llc_request_t> &get_requests() { return(requests); }
+   void end_quantum();
+
+   void reset_stats() { copy->reset_stats(); }
+   void stats() { copy->stats(); }
+   uint64_t get_latency() const { return(copy->get_latency()); }
+   uint64_t get_accesses() const { return(copy->get_accesses()); }
+   uint64_t get_misses() const { return(copy->get_misses()); }
+   cache_stats_t get_stats() const { return(copy->get_stats()); }
+   void add_stats(const cache_stats_t &s) { copy->add_stats(s); }
+   uint64_t footprint() const { return(copy->footprint()); }
+};
+
+struct core_t {
+   const char *trace_name;
+   CVPTraceReader *reader;
+   shared_cache_port_t *port;
+   uarchsim_t *sim;
+   uint64_t num_sim;	// simulated instructions (including warm-up)
+   bool done;
+};
+
+class multicore_t {
+private:
+   cache_t *llc;
+   std::vector<core_t> cores;
+   uint64_t quantum;
+   uint64_t quantum_end;		// fetch cycle at which the current quantum ends
+   uint64_t num_quanta;
+   bool llc_stats_reset;		// shared L3 measurements restarted after all cores warmed up
+   bool all_done;
+
+   // barrier
+   std::mutex mtx;
+   std::condition_variable cv;
+   uint64_t arrived;
+   uint64_t generation;
+
+   void run_quantum(core_t &c);
+   void end_quantum();		// runs in the last thread to reach the barrier
+   void barrier();
+   void run_core(uint64_t i);	// host thread of core i
+
+public:
+   multicore_t(uint64_t num_cores, char **trace_names, uint64_t quantum);
+   ~multicore_t();
+
+   void run();
+
+   // Host memory of the cores and the shared L3, in bytes, counting the alone runs of output(),
+   // which overlap with the cores.
+   uint64_t footprint() const;
+
+   // Run each trace alone (private L3) for the same instructions, and report per-core IPC,
+   // alone IPC and weighted speedup.
+   void output();
+};
+
+#endif
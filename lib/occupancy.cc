@@ -0,0 +1,83 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <assert.h>
+#include "occupancy.h"
+
+occupancy_timeline_t::occupancy_timeline_t(uint64_t capacity) {
+   assert(capacity > 0);
+   this->capacity = capacity;
+}
+
+occupancy_timeline_t::~occupancy_timeline_t() {
+}
+
+uint64_t occupancy_timeline_t::find(uint64_t cycle, uint64_t duration) const {
+   uint64_t start = cycle;
+   auto it = steps.upper_bound(cycle);
+   uint64_t level = ((it == steps.begin()) ? 0 : std::prev(it)->second);
+
+   // Walk the steps from the one holding "cycle": "level" lasts until "it".
+   while (true) {
+      if (level >= capacity)
+         start = it->first;	// full: the last step is empty, so "it" is a real step
+      else if ((it == steps.end()) || (it->first >= (start + duration)))
+         return(start);
+      level = it->second;
+      ++it;
+   }
+}
+
+std::map<uint64_t, uint32_t>::iterator occupancy_timeline_t::split(uint64_t cycle) {
+   auto it = steps.lower_bound(cycle);
+   if ((it != steps.end()) && (it->first == cycle))
+      return(it);
+   uint32_t level = ((it == steps.begin()) ? 0 : std::prev(it)->second);
+   return(steps.emplace_hint(it, cycle, level));
+}
+
+void occupancy_timeline_t::add(uint64_t start, uint64_t end) {
+   if (start >= end)
+      return;
+
+   auto first = split(start);
+   auto last = split(end);
+   for (auto it = first; it != last; ++it)
+      it->second++;
+
+   // Merge the ends with their neighbors if they no longer change the occupancy.
+   if (std::prev(last)->second == last->second)
+      steps.erase(last);
+   if ((first != steps.begin()) && (std::prev(first)->second == first->second))
+      steps.erase(first);
+}
+
+void occupancy_timeline_t::forget(uint64_t cycle) {
+   auto it = steps.upper_bound(cycle);
+   uint32_t level = std::prev(it)->second;
+   steps.erase(steps.begin(), it);
+   if (level)
+      steps.emplace_hint(it, cycle, level);
+}
@@ -0,0 +1,64 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _OCCUPANCY_H_
+#define _OCCUPANCY_H_
+
+#include <inttypes.h>
+#include <map>
+
+// Occupancy of a pool of identical entries (MSHRs, a memory bus) over time, as a step
+// function: "steps" maps each cycle at which the occupancy changes to the occupancy from
+// that cycle until the next key. The occupancy is 0 before the first key and after the
+// last one. Reservations may arrive in any cycle order. Adjacent steps of equal occupancy
+// are merged and steps that no later request can reach are pruned, so the map only holds
+// the reservations in flight and each search or update is O(log n) in their number.
+
+class occupancy_timeline_t {
+private:
+   std::map<uint64_t, uint32_t> steps;
+   uint64_t capacity;	// entries in the pool
+
+   // Key at "cycle", inserted with the occupancy it starts with if there is none.
+   std::map<uint64_t, uint32_t>::iterator split(uint64_t cycle);
+   void forget(uint64_t cycle);
+
+public:
+   occupancy_timeline_t(uint64_t capacity);
+   ~occupancy_timeline_t();
+
+   // First cycle at or after "cycle" from which an entry is free for "duration" cycles.
+   uint64_t find(uint64_t cycle, uint64_t duration) const;
+   // Hold an entry from "start" up to (not including) "end". The capacity is not checked.
+   void add(uint64_t start, uint64_t end);
+   // Forget the occupancy before "cycle", which no later request precedes.
+   void prune(uint64_t cycle) {
+      if (!steps.empty() && (steps.begin()->first < cycle))
+         forget(cycle);
+   }
+
+   uint64_t footprint() const { return(steps.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + (4 * sizeof(void *)))); }	// host memory, in bytes (map nodes)
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include "oracle.h"
+
+pc_ranges_t::pc_ranges_t() {
+   min_pc = 1;		// empty set: no PC passes the bounds check
+   max_pc = 0;
+}
+
+void pc_ranges_t::add(uint64_t lo, uint64_t hi) {
+   ranges.push_back({lo, hi});
+}
+
+void pc_ranges_t::finalize() {
+   std::sort(ranges.begin(), ranges.end(), [](const range_t &a, const range_t &b) { return(a.lo < b.lo); });
+
+   uint64_t n = 0;
+   for (uint64_t i = 0; i < ranges.size(); i++) {
+      // overlapping or adjacent: merge (written so that a range ending at UINT64_MAX cannot wrap)
+      if (n && ((ranges[i].lo <= ranges[n - 1].hi) || ((ranges[i].lo - 1) == ranges[n - 1].hi))) {
+         ranges[n - 1].hi = std::max(ranges[n - 1].hi, ranges[i].hi);
+      }
+      else {
+         ranges[n] = ranges[i];
+         n++;
+      }
+   }
+   ranges.resize(n);
+
+   if (n) {
+      min_pc = ranges[0].lo;
+      max_pc = ranges[n - 1].hi;
+   }
+}
+
+oracle_t::oracle_t(const char *filename) {
+   FILE *fp = fopen(filename, "r");
+   if (!fp) {
+      printf("Error: could not open oracle overrides file %s.\n", filename);
+      exit(1);
+   }
+
+   char line[256];
+   uint64_t line_num = 0;
+   while (fgets(line, sizeof(line), fp)) {
+      line_num++;
+      char *comment = strchr(line, '#');
+      if (comment)
+         *comment = '\0';
+
+      char kind[8];
+      char pcs[128];
+      int n = sscanf(line, "%7s %127s", kind, pcs);
+      if (n <= 0)
+         continue;	// blank line
+
+      pc_ranges_t *set = (!strcmp(kind, "vp") ? &vp : (!strcmp(kind, "l1") ? &l1 : (!strcmp(kind, "bp") ? &bp : (pc_ranges_t *)NULL)));
+      char *end = pcs;
+      uint64_t lo = 0, hi = 0;
+      bool ok = (set && (n == 2));
+      if (ok) {
+         lo = hi = strtoull(pcs, &end, 16);
+         ok = (end != pcs);
+         if (ok && (*end == '-')) {
+            char *start = end + 1;
+            hi = strtoull(start, &end, 16);
+            ok = ((end != start) && (hi >= lo));
+         }
+         ok = (ok && (*end == '\0'));
+      }
+      if (!ok) {
+         printf("Error: %s, line %lu: expected \"vp|l1|bp <pc>[-<pc>]\".\n", filename, line_num);
+         exit(1);
+      }
+      set->add(lo, hi);
+   }
+   fclose(fp);
+
+   vp.finalize();
+   l1.finalize();
+   bp.finalize();
+}
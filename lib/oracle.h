@@ -0,0 +1,84 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _ORACLE_H_
+#define _ORACLE_H_
+
+#include <inttypes.h>
+#include <vector>
+
+// Set of PCs, kept as sorted, disjoint, inclusive ranges. Lookup is a binary search,
+// preceded by a bounds check that rejects most PCs of a large program outright.
+class pc_ranges_t {
+private:
+   struct range_t {
+      uint64_t lo;
+      uint64_t hi;
+   };
+   std::vector<range_t> ranges;
+   uint64_t min_pc;
+   uint64_t max_pc;
+
+public:
+   pc_ranges_t();
+
+   void add(uint64_t lo, uint64_t hi);
+   void finalize();	// sort and merge the ranges: call after the last add()
+
+   inline bool contains(uint64_t pc) const {
+      if ((pc < min_pc) || (pc > max_pc))
+         return(false);
+      uint64_t lo = 0;
+      uint64_t hi = ranges.size();
+      while (lo < hi) {		// find the first range that ends at or after "pc"
+         uint64_t mid = (lo + hi) / 2;
+         if (ranges[mid].hi < pc)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      return((lo < ranges.size()) && (ranges[lo].lo <= pc));
+   }
+
+   uint64_t size() const { return(ranges.size()); }
+};
+
+// Per-PC oracle overrides, for sizing the benefit of fixing specific instructions.
+// The file has one entry per line, "#" starts a comment:
+//
+//    vp <pc>[-<pc>]	perfect value prediction
+//    l1 <pc>[-<pc>]	perfect L1 data cache (loads and stores)
+//    bp <pc>[-<pc>]	perfect branch direction and target prediction
+//
+// PCs are hexadecimal ("0x" optional); a range includes both ends.
+class oracle_t {
+public:
+   pc_ranges_t vp;
+   pc_ranges_t l1;
+   pc_ranges_t bp;
+
+   oracle_t(const char *filename);	// exits with an error message on a malformed file
+};
+
+#endif
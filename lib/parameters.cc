@@ -22,6 +22,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
 
+#include <stddef.h>
 #include <inttypes.h>
 
 bool VP_ENABLE = false;
@@ -36,6 +37,10 @@ bool FETCH_MODEL_ICACHE = true;
 
 bool PERFECT_BRANCH_PRED = false;
 bool PERFECT_INDIRECT_PRED = false;
+bool BP_AHEAD = false;			// run branch prediction on a separate thread, ahead of the timing model
+const char *BP_SIDECAR_FILE = NULL;	// branch outcome sidecar, loaded if it matches, otherwise recorded; NULL: none
+const char *FU_POOLS = NULL;		// functional-unit pools per instruction class (see fu_pool.h); NULL: ALU lanes only
+const char *ORACLE_FILE = NULL;		// per-PC oracle overrides (perfect VP, L1 or BP for listed PCs); NULL: none
 uint64_t PIPELINE_FILL_LATENCY = 5;
 uint64_t NUM_LDST_LANES = 8;
 uint64_t NUM_ALU_LANES = 16;
@@ -64,3 +69,43 @@ uint64_t L3_BLOCKSIZE = 128;
 uint64_t L3_LATENCY = 60;
 
 uint64_t MAIN_MEMORY_LATENCY = 150;
+
+uint64_t IC_MSHRS = 0;		// outstanding misses of each cache level; 0: unlimited
+uint64_t L1_MSHRS = 0;
+uint64_t L2_MSHRS = 0;
+uint64_t L3_MSHRS = 0;
+uint64_t MAIN_MEMORY_BANDWIDTH = 0;	// bytes per cycle between the last cache level and main memory; 0: unlimited
+
+uint64_t IC_REPL = 0;	// replacement policy of each cache level (ReplPolicies): LRU
+uint64_t L1_REPL = 0;
+uint64_t L2_REPL = 0;
+uint64_t L3_REPL = 0;
+
+uint64_t SKIP_INSTS = 0;	// fast-forwarded instructions: decoded but not simulated
+uint64_t WARMUP_INSTS = 0;	// simulated instructions excluded from measurements
+uint64_t MAX_INSTS = 0;		// 0: until end of trace; >0: measured instructions after warm-up
+
+uint64_t INTERVAL_INSTS = 0;	// 0: no time-series; >0: emit a record every INTERVAL_INSTS measured instructions
+const char *INTERVAL_STATS_FILE = NULL;
+
+const char *PROFILE_TRACE_FILE = NULL;	// Chrome-trace export of the simulator profile (PROFILE=1 builds)
+
+uint64_t PIPEVIEW_START = 0;		// first micro-op (counted from the start of simulation) in the pipeline view
+uint64_t PIPEVIEW_COUNT = 0;		// number of micro-ops in the pipeline view
+const char *PIPEVIEW_FILE = NULL;	// NULL: no pipeline view
+
+const char *LIVE_STATS_FILE = NULL;	// NULL: no live counters page
+
+uint64_t MEMORY_BUDGET = 0;		// bytes; 0: no memory budget
+bool HUGE_PAGES = true;			// back the large tables with 2MB pages (see arena.h)
+
+uint64_t NUM_CORES = 0;			// 0: single-core simulation; >0: multi-core simulation with a shared L3, one trace per core
+uint64_t QUANTUM_CYCLES = 1000;		// multi-core: cycles between synchronizations of the cores
+
+uint64_t NUM_SHARDS = 0;		// 0: serial simulation; >0: simulate the trace in NUM_SHARDS parallel shards
+uint64_t SHARD_OVERLAP = 0;		// warm-up instructions of each shard (except the first)
+bool SHARD_VERIFY = false;		// also simulate serially and report the error of the merged result
+
+uint64_t CONVERGENCE_INTERVAL = 0;	// 0: no early termination; >0: instructions per confidence-interval sample
+double CONVERGENCE_REL_ERR = 0.01;	// stop when the 95% confidence interval is within this relative error
+const char *CONVERGENCE_METRICS = "i";	// tracked metrics: i (IPC, always), m (branch MPKI), v (VP coverage)
@@ -44,6 +44,10 @@ extern bool FETCH_MODEL_ICACHE;
 
 extern bool PERFECT_BRANCH_PRED;
 extern bool PERFECT_INDIRECT_PRED;
+extern const char *ORACLE_FILE;
+extern bool BP_AHEAD;
+extern const char *BP_SIDECAR_FILE;
+extern const char *FU_POOLS;
 extern uint64_t PIPELINE_FILL_LATENCY;
 extern uint64_t NUM_LDST_LANES;
 extern uint64_t NUM_ALU_LANES;
@@ -73,4 +77,54 @@ extern uint64_t L3_LATENCY;
 
 extern uint64_t MAIN_MEMORY_LATENCY;
 
+extern uint64_t IC_MSHRS;
+extern uint64_t L1_MSHRS;
+extern uint64_t L2_MSHRS;
+extern uint64_t L3_MSHRS;
+extern uint64_t MAIN_MEMORY_BANDWIDTH;
+
+enum class ReplPolicies
+{
+    LRU = 0,
+    PLRU,
+    SRRIP,
+    BRRIP,
+    Random,
+    NumPolicies
+};
+
+extern uint64_t IC_REPL;
+extern uint64_t L1_REPL;
+extern uint64_t L2_REPL;
+extern uint64_t L3_REPL;
+
+extern uint64_t SKIP_INSTS;
+extern uint64_t WARMUP_INSTS;
+extern uint64_t MAX_INSTS;
+
+extern uint64_t INTERVAL_INSTS;
+extern const char *INTERVAL_STATS_FILE;
+
+extern const char *PROFILE_TRACE_FILE;
+
+extern uint64_t PIPEVIEW_START;
+extern uint64_t PIPEVIEW_COUNT;
+extern const char *PIPEVIEW_FILE;
+
+extern const char *LIVE_STATS_FILE;
+
+extern uint64_t MEMORY_BUDGET;
+extern bool HUGE_PAGES;
+
+extern uint64_t NUM_CORES;
+extern uint64_t QUANTUM_CYCLES;
+
+extern uint64_t NUM_SHARDS;
+extern uint64_t SHARD_OVERLAP;
+extern bool SHARD_VERIFY;
+
+extern uint64_t CONVERGENCE_INTERVAL;
+extern double CONVERGENCE_REL_ERR;
+extern const char *CONVERGENCE_METRICS;
+
 #endif
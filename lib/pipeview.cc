@@ -0,0 +1,173 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <chrono>
+#include "cvp.h"
+#include "pipeview.h"
+
+#define PIPEVIEW_FILE_BUFSIZE	(1 << 22)
+
+static const char *pipeview_mnemonic[] = {
+   "alu", "ld", "st", "b.cond", "b", "br", "fp", "alu.slow", "undef"
+};
+
+pipeview_writer_t::pipeview_writer_t(const char *filename) : head(0), tail(0), done(false) {
+   fp = fopen(filename, "w");
+   if (!fp) {
+      printf("Error: could not open pipeline view file %s.\n", filename);
+      exit(1);
+   }
+   setvbuf(fp, NULL, _IOFBF, PIPEVIEW_FILE_BUFSIZE);
+
+   ring = new pipeview_record_t[PIPEVIEW_RING_SIZE];
+   writer = std::thread(&pipeview_writer_t::drain, this);
+}
+
+pipeview_writer_t::~pipeview_writer_t() {
+   close();
+   delete [] ring;
+}
+
+void pipeview_writer_t::record(const pipeview_record_t &r) {
+   uint64_t t = tail.load(std::memory_order_relaxed);
+   while ((t - head.load(std::memory_order_acquire)) == PIPEVIEW_RING_SIZE)
+      std::this_thread::yield();	// ring full
+   ring[t & (PIPEVIEW_RING_SIZE - 1)] = r;
+   tail.store(t + 1, std::memory_order_release);
+}
+
+void pipeview_writer_t::drain() {
+   uint64_t h = head.load(std::memory_order_relaxed);
+   while (true) {
+      bool stop = done.load(std::memory_order_acquire);	// read before tail: records queued before close() are seen
+      uint64_t t = tail.load(std::memory_order_acquire);
+      if (h == t) {
+         if (stop)
+            break;
+         std::this_thread::sleep_for(std::chrono::microseconds(100));
+         continue;
+      }
+      for (; h != t; h++) {
+         write_record(ring[h & (PIPEVIEW_RING_SIZE - 1)]);
+         if ((h & 1023) == 1023)
+            head.store(h + 1, std::memory_order_release);	// free slots in batches
+      }
+      head.store(h, std::memory_order_release);
+   }
+}
+
+// The writer thread must keep up with the simulator, so records are formatted by hand rather than with printf.
+static char *put_str(char *p, const char *s) {
+   while (*s)
+      *p++ = *s++;
+   return(p);
+}
+
+static char *put_dec(char *p, uint64_t x) {
+   char tmp[20];
+   int n = 0;
+   do {
+      tmp[n++] = ('0' + (x % 10));
+      x /= 10;
+   } while (x);
+   while (n)
+      *p++ = tmp[--n];
+   return(p);
+}
+
+static char *put_hex(char *p, uint64_t x, int min_digits) {
+   static const char digits[] = "0123456789abcdef";
+   char tmp[16];
+   int n = 0;
+   do {
+      tmp[n++] = digits[x & 15];
+      x >>= 4;
+   } while (x || (n < min_digits));
+   while (n)
+      *p++ = tmp[--n];
+   return(p);
+}
+
+void pipeview_writer_t::write_record(const pipeview_record_t &r) {
+   char line[512];
+   char *p = line;
+   uint64_t fetch = r.fetch_cycle * PIPEVIEW_TICKS_PER_CYCLE;
+   const char *mnemonic = pipeview_mnemonic[(r.insn <= (uint8_t)undefInstClass) ? r.insn : (uint8_t)undefInstClass];
+
+   // O3PipeView:fetch:<tick>:<pc>:<micro-op>:<seq_no>:<disassembly>
+   p = put_str(p, "O3PipeView:fetch:");
+   p = put_dec(p, fetch);
+   p = put_str(p, ":0x");
+   p = put_hex(p, r.pc, 16);
+   *p++ = ':';
+   p = put_dec(p, r.piece);
+   *p++ = ':';
+   p = put_dec(p, r.seq_no);
+   *p++ = ':';
+   p = put_str(p, mnemonic);
+   if ((r.insn == loadInstClass) || (r.insn == storeInstClass)) {
+      p = put_str(p, " [0x");
+      p = put_hex(p, r.addr, 1);
+      p = put_str(p, "], ");
+      p = put_dec(p, r.size);
+      *p++ = 'B';
+   }
+   if (r.vp_squash)
+      p = put_str(p, " (value mispredicted)");
+   if (r.br_misp)
+      p = put_str(p, " (branch mispredicted)");
+
+   p = put_str(p, "\nO3PipeView:decode:");
+   p = put_dec(p, fetch);
+   p = put_str(p, "\nO3PipeView:rename:");
+   p = put_dec(p, fetch);
+   p = put_str(p, "\nO3PipeView:dispatch:");
+   p = put_dec(p, fetch);
+   p = put_str(p, "\nO3PipeView:issue:");
+   p = put_dec(p, r.issue_cycle * PIPEVIEW_TICKS_PER_CYCLE);
+   p = put_str(p, "\nO3PipeView:complete:");
+   p = put_dec(p, r.complete_cycle * PIPEVIEW_TICKS_PER_CYCLE);
+   p = put_str(p, "\nO3PipeView:retire:");
+   p = put_dec(p, r.retire_cycle * PIPEVIEW_TICKS_PER_CYCLE);
+   p = put_str(p, ":store:");
+   p = put_dec(p, r.store_cycle * PIPEVIEW_TICKS_PER_CYCLE);
+   *p++ = '\n';
+
+   assert((uint64_t)(p - line) <= sizeof(line));
+   fwrite(line, 1, (p - line), fp);
+}
+
+void pipeview_writer_t::close() {
+   if (fp) {
+      done.store(true, std::memory_order_release);
+      writer.join();
+      fclose(fp);
+      fp = NULL;
+   }
+}
@@ -0,0 +1,83 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _PIPEVIEW_H_
+#define _PIPEVIEW_H_
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+// Per-micro-op pipeline timeline export in gem5's O3PipeView text format, which
+// pipeline viewers such as Konata and gem5's o3-pipeview.py understand.
+//
+// The simulator does not model decode, rename and dispatch separately: they are
+// reported at the fetch cycle, so the gap before "issue" covers the pipeline fill
+// latency, operand readiness and lane contention.
+
+#define PIPEVIEW_TICKS_PER_CYCLE	1000	// gem5 convention: 1000 ticks per cycle
+#define PIPEVIEW_RING_SIZE		(1 << 16)	// records; must be a power of 2
+
+struct pipeview_record_t {
+   uint64_t seq_no;
+   uint64_t pc;
+   uint64_t addr;		// effective address of loads and stores
+   uint64_t fetch_cycle;
+   uint64_t issue_cycle;	// execution lane acquired
+   uint64_t complete_cycle;	// result available
+   uint64_t retire_cycle;
+   uint64_t store_cycle;	// stores: data written to the cache (0 otherwise)
+   uint8_t insn;		// InstClass
+   uint8_t piece;		// micro-op number within the trace instruction
+   uint8_t size;		// access size of loads and stores
+   bool vp_squash;		// value misprediction
+   bool br_misp;		// branch misprediction
+};
+
+// Records go into a single-producer/single-consumer ring buffer; a background
+// thread formats them and writes the file, so the simulator only copies a record.
+class pipeview_writer_t {
+private:
+   FILE *fp;
+   pipeview_record_t *ring;
+   std::atomic<uint64_t> head;	// next record to write out (consumer)
+   std::atomic<uint64_t> tail;	// next free slot (producer)
+   std::atomic<bool> done;
+   std::thread writer;
+
+   void drain();		// writer thread
+   void write_record(const pipeview_record_t &r);
+
+public:
+   pipeview_writer_t(const char *filename);
+   ~pipeview_writer_t();
+
+   // Queue a record; waits only if the writer thread has fallen a full ring behind.
+   void record(const pipeview_record_t &r);
+
+   // Write out all queued records, stop the writer thread and close the file.
+   void close();
+};
+
+#endif
@@ -0,0 +1,162 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "profiler.h"
+#include "arena.h"
+
+#ifdef CVP_PROFILE
+
+thread_local profiler_t profiler;
+
+static const char *prof_phase_names[PROF_NUM_PHASES] = {
+   "decode",
+   "retire",
+   "icache",
+   "value prediction",
+   "operands",
+   "lanes",
+   "dcache",
+   "store queue",
+   "prefetch drain",
+   "fetch",
+   "branch prediction",
+   "advance base cycle",
+};
+
+static uint64_t prof_ns() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((uint64_t)ts.tv_sec * 1000000000lu + ts.tv_nsec);
+}
+
+// Minor page faults of the calling thread.
+static uint64_t prof_minflt() {
+   struct rusage ru;
+   if (getrusage(RUSAGE_THREAD, &ru))
+      return(0);
+   return((uint64_t)ru.ru_minflt);
+}
+
+// Count the calling thread's user-mode DTLB misses of accesses of type "op".
+static int prof_open_tlb(uint64_t op) {
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.size = sizeof(attr);
+   attr.type = PERF_TYPE_HW_CACHE;
+   attr.config = (PERF_COUNT_HW_CACHE_DTLB | (op << 8) | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   return((int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+profiler_t::profiler_t() {
+   for (int i = 0; i < PROF_NUM_PHASES; i++) {
+      total[i] = 0;
+      calls[i] = 0;
+   }
+   tracing = false;
+   start_ticks = prof_ticks();
+   start_ns = prof_ns();
+
+   tlb_fd[0] = prof_open_tlb(PERF_COUNT_HW_CACHE_OP_READ);
+   tlb_errno = ((tlb_fd[0] < 0) ? errno : 0);
+   tlb_fd[1] = prof_open_tlb(PERF_COUNT_HW_CACHE_OP_WRITE);
+   start_minflt = prof_minflt();
+}
+
+profiler_t::~profiler_t() {
+   for (int i = 0; i < 2; i++)
+      if (tlb_fd[i] >= 0)
+         close(tlb_fd[i]);
+}
+
+// Calibrate the tick rate over the whole run.
+double profiler_t::ticks_per_us() {
+   uint64_t ticks = (prof_ticks() - start_ticks);
+   uint64_t ns = (prof_ns() - start_ns);
+   return((ns > 0) ? (1000.0*(double)ticks/(double)ns) : 1.0);
+}
+
+void profiler_t::output() {
+   uint64_t sum = 0;
+   for (int i = 0; i < PROF_NUM_PHASES; i++)
+      sum += total[i];
+
+   printf("SIMULATOR PROFILE----------------------------------\n");
+   printf("Phase                      calls          ticks      %%  ticks/call\n");
+   for (int i = 0; i < PROF_NUM_PHASES; i++) {
+      printf("%-18s %13lu %14lu %6.2f%% %10.1f\n", prof_phase_names[i], calls[i], total[i],
+             ((sum > 0) ? (100.0*(double)total[i]/(double)sum) : 0.0),
+             ((calls[i] > 0) ? ((double)total[i]/(double)calls[i]) : 0.0));
+   }
+   printf("%-18s %13s %14lu\n", "total", "", sum);
+   printf("ticks per us = %.1f\n", ticks_per_us());
+
+   // Host memory behavior (a core's thread, in multi-core simulation).
+   uint64_t insts = calls[PROF_DECODE];
+   if (tlb_fd[0] >= 0) {
+      uint64_t miss[2] = {0, 0};
+      for (int i = 0; i < 2; i++)
+         if ((tlb_fd[i] >= 0) && (read(tlb_fd[i], &miss[i], sizeof(miss[i])) != sizeof(miss[i])))
+            miss[i] = 0;
+      printf("host DTLB misses = %lu loads, %lu stores (%.2f per 1000 decoded instructions)\n", miss[0], miss[1],
+             ((insts > 0) ? (1000.0*(double)(miss[0] + miss[1])/(double)insts) : 0.0));
+   }
+   else {
+      printf("host DTLB misses = unavailable (perf_event_open: %s)\n", strerror(tlb_errno));
+   }
+   printf("host minor page faults = %lu\n", (prof_minflt() - start_minflt));
+   arena_output();
+}
+
+bool profiler_t::export_chrome_trace(const char *filename) {
+   FILE *fp = fopen(filename, "w");
+   if (!fp)
+      return(false);
+
+   double scale = ticks_per_us();
+   uint64_t base = (events.empty() ? 0 : events[0].start);
+
+   fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+   for (uint64_t i = 0; i < events.size(); i++) {
+      const prof_event_t &e = events[i];
+      fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}\n",
+              ((i > 0) ? "," : ""), prof_phase_names[e.phase],
+              (double)(e.start - base)/scale, (double)(e.end - e.start)/scale);
+   }
+   fprintf(fp, "]}\n");
+   fclose(fp);
+   return(true);
+}
+
+#endif
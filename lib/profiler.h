@@ -0,0 +1,127 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+// Hot-path profiler for the simulator itself (not the simulated machine).
+//
+// Build with "make PROFILE=1" to define CVP_PROFILE. Each phase of uarchsim_t::step()
+// and trace decode is then bracketed by PROF_BEGIN()/PROF_END(), which read the
+// time-stamp counter and accumulate per-phase totals and call counts.
+// Without CVP_PROFILE the macros expand to nothing.
+//
+// The profile also reports the host's DTLB misses and page faults while simulating, for
+// judging the table arena's huge pages (see arena.h; compare with -X).
+
+enum prof_phase_t {
+   PROF_DECODE = 0,	// trace decode (CVPTraceReader::get_inst())
+   PROF_RETIRE,		// window retirement and updatePredictor()
+   PROF_ICACHE,		// instruction cache lookup
+   PROF_VP,		// value prediction
+   PROF_OPERANDS,	// source operand scheduling
+   PROF_LANES,		// execution lane scheduling
+   PROF_DCACHE,		// prefetcher training and data cache lookup of loads
+   PROF_SQ,		// store queue search (loads) and update (stores)
+   PROF_PREFETCH,	// prefetch queue drain
+   PROF_FETCH,		// window dispatch and fetch bundle management
+   PROF_BP,		// branch prediction
+   PROF_ADVANCE,	// resource schedule base cycle advance
+   PROF_NUM_PHASES
+};
+
+#ifdef CVP_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t prof_ticks() { return(__rdtsc()); }
+#else
+#include <time.h>
+static inline uint64_t prof_ticks() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((uint64_t)ts.tv_sec * 1000000000lu + ts.tv_nsec);
+}
+#endif
+
+#include <vector>
+
+// Upper bound on the number of events kept for the Chrome trace (the rest are only counted).
+#define PROF_MAX_TRACE_EVENTS	(1 << 20)
+
+struct prof_event_t {
+   uint64_t start;
+   uint64_t end;
+   uint32_t phase;
+};
+
+class profiler_t {
+private:
+   uint64_t total[PROF_NUM_PHASES];
+   uint64_t calls[PROF_NUM_PHASES];
+
+   bool tracing;
+   std::vector<prof_event_t> events;
+
+   // For converting ticks to time.
+   uint64_t start_ticks;
+   uint64_t start_ns;
+
+   // Host DTLB load and store miss counters of this thread (-1: unavailable), and page faults so far.
+   int tlb_fd[2];
+   int tlb_errno;
+   uint64_t start_minflt;
+
+   double ticks_per_us();
+
+public:
+   profiler_t();
+   ~profiler_t();
+
+   inline void record(prof_phase_t phase, uint64_t start, uint64_t end) {
+      total[phase] += (end - start);
+      calls[phase]++;
+      if (tracing && (events.size() < PROF_MAX_TRACE_EVENTS))
+         events.push_back({start, end, (uint32_t)phase});
+   }
+
+   void enable_trace() { tracing = true; }
+
+   void output();
+   bool export_chrome_trace(const char *filename);
+};
+
+// One profiler per host thread (multi-core simulation runs each core on its own thread).
+extern thread_local profiler_t profiler;
+
+#define PROF_BEGIN(phase)	uint64_t prof_start_##phase = prof_ticks()
+#define PROF_END(phase)		profiler.record(phase, prof_start_##phase, prof_ticks())
+
+#else
+
+#define PROF_BEGIN(phase)
+#define PROF_END(phase)
+
+#endif
+
+#endif
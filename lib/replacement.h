@@ -0,0 +1,225 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _REPLACEMENT_H_
+#define _REPLACEMENT_H_
+
+#include <inttypes.h>
+#include <string.h>
+
+// Cache replacement policies.
+//
+// Each policy keeps its per-set state in "words(assoc)" 64-bit words of the set's
+// metadata ("m"), and provides:
+//   init(m, assoc)               state of an empty set
+//   touch(m, assoc, way)         a hit to "way"
+//   insert(m, assoc, way, state) "way" was filled with a new block
+//   victim(m, assoc, state)      the way to replace (the set has no invalid way)
+// and "touch_mru_is_noop": whether a hit to the way touched or inserted last leaves the
+// state unchanged, so that cache_t may skip it.
+// "state" is per-cache state shared by all sets (random number generator, BRRIP
+// throttle). All updates take constant time, for the associativities each policy
+// accepts ("max_assoc"). cache_t is instantiated once per policy (see cache.cc).
+
+// True LRU, as a recency stack of 4-bit way numbers packed in one word: nibble p
+// holds the way in recency position p, with the MRU way in nibble 0.
+struct repl_lru_t {
+   static const uint64_t max_assoc = 16;
+   static const bool touch_mru_is_noop = true;
+   static uint64_t words(uint64_t assoc) { return(1); }
+
+   static void init(uint64_t *m, uint64_t assoc) {
+      m[0] = 0;
+      for (uint64_t p = 0; p < assoc; p++)
+         m[0] |= (p << (4 * p));
+   }
+
+   static void touch(uint64_t *m, uint64_t assoc, uint64_t way) {
+      uint64_t x = m[0];
+      // Locate "way" in the stack: the lowest nibble of x^way*0x11..1 that is zero
+      // (nibbles past "assoc" are zero too, but lie above the real position).
+      uint64_t y = (x ^ (way * 0x1111111111111111ULL));
+      uint64_t z = ((y - 0x1111111111111111ULL) & ~y & 0x8888888888888888ULL);
+      uint64_t p = (__builtin_ctzll(z) >> 2);
+      if (p == 0)
+         return;	// already MRU
+      uint64_t below = (x & ((1ULL << (4 * p)) - 1));			// more recent than "way"
+      uint64_t above = ((p == 15) ? 0 : (x & ~((1ULL << (4 * (p + 1))) - 1)));
+      m[0] = (above | (below << 4) | way);
+   }
+
+   static void insert(uint64_t *m, uint64_t assoc, uint64_t way, uint64_t &state) {
+      touch(m, assoc, way);
+   }
+
+   static uint64_t victim(const uint64_t *m, uint64_t assoc, uint64_t &state) {
+      return((m[0] >> (4 * (assoc - 1))) & 0xf);
+   }
+};
+
+// True LRU for more than 16 ways: a recency stack of 16-bit way numbers.
+// Moving a way to the top shifts the more recent ways down (one memmove).
+struct repl_lru_wide_t {
+   static const uint64_t max_assoc = (1 << 16);
+   static const bool touch_mru_is_noop = true;
+   static uint64_t words(uint64_t assoc) { return(((assoc * sizeof(uint16_t)) + 7) / 8); }
+
+   static void init(uint64_t *m, uint64_t assoc) {
+      uint16_t *s = (uint16_t *)m;
+      for (uint64_t p = 0; p < assoc; p++)
+         s[p] = p;
+   }
+
+   static void touch(uint64_t *m, uint64_t assoc, uint64_t way) {
+      uint16_t *s = (uint16_t *)m;
+      uint64_t p = 0;
+      while (s[p] != way)
+         p++;
+      memmove(s + 1, s, p * sizeof(uint16_t));
+      s[0] = way;
+   }
+
+   static void insert(uint64_t *m, uint64_t assoc, uint64_t way, uint64_t &state) {
+      touch(m, assoc, way);
+   }
+
+   static uint64_t victim(const uint64_t *m, uint64_t assoc, uint64_t &state) {
+      return(((const uint16_t *)m)[assoc - 1]);
+   }
+};
+
+// Tree pseudo-LRU: assoc-1 bits in one word, node n (1 <= n < assoc) with children
+// 2n and 2n+1 and the ways as leaves assoc .. 2*assoc-1. A node's bit points to the
+// subtree to replace next (0: left, 1: right). Power-of-2 associativity.
+struct repl_plru_t {
+   static const uint64_t max_assoc = 64;
+   static const bool touch_mru_is_noop = true;
+   static uint64_t words(uint64_t assoc) { return(1); }
+
+   static void init(uint64_t *m, uint64_t assoc) {
+      m[0] = 0;
+   }
+
+   static void touch(uint64_t *m, uint64_t assoc, uint64_t way) {
+      uint64_t x = m[0];
+      // Walk up from the leaf, pointing each ancestor away from "way".
+      for (uint64_t n = (assoc + way); n > 1; n >>= 1) {
+         uint64_t parent = (n >> 1);
+         if (n & 1)
+            x &= ~(1ULL << parent);
+         else
+            x |= (1ULL << parent);
+      }
+      m[0] = x;
+   }
+
+   static void insert(uint64_t *m, uint64_t assoc, uint64_t way, uint64_t &state) {
+      touch(m, assoc, way);
+   }
+
+   static uint64_t victim(const uint64_t *m, uint64_t assoc, uint64_t &state) {
+      uint64_t n = 1;
+      while (n < assoc)
+         n = ((n << 1) | ((m[0] >> n) & 1));
+      return(n - assoc);
+   }
+};
+
+// Re-reference interval prediction (Jaleel et al., ISCA 2010): a 2-bit re-reference
+// prediction value (RRPV) per way, packed in one word. A hit predicts a near
+// re-reference (0). The victim is the first way with a distant RRPV (3), after aging
+// all ways just enough for one to reach it. SRRIP inserts with a long RRPV (2); BRRIP
+// inserts with a distant RRPV, and a long one every BRRIP_THROTTLE-th insertion.
+#define RRPV_ONES		0x5555555555555555ULL	// low bit of every 2-bit field
+#define BRRIP_THROTTLE	32
+
+template <bool bimodal>
+struct repl_rrip_t {
+   static const uint64_t max_assoc = 32;
+   static const bool touch_mru_is_noop = false;	// the first hit after insertion promotes the way
+   static uint64_t words(uint64_t assoc) { return(1); }
+
+   static uint64_t fields(uint64_t assoc) { return((assoc == 32) ? ~0ULL : ((1ULL << (2 * assoc)) - 1)); }
+
+   static void init(uint64_t *m, uint64_t assoc) {
+      m[0] = (fields(assoc) & (3 * RRPV_ONES));
+   }
+
+   static void set(uint64_t *m, uint64_t way, uint64_t rrpv) {
+      m[0] = ((m[0] & ~(3ULL << (2 * way))) | (rrpv << (2 * way)));
+   }
+
+   static void touch(uint64_t *m, uint64_t assoc, uint64_t way) {
+      set(m, way, 0);
+   }
+
+   static void insert(uint64_t *m, uint64_t assoc, uint64_t way, uint64_t &state) {
+      if (bimodal)
+         set(m, way, (((++state % BRRIP_THROTTLE) == 0) ? 2 : 3));
+      else
+         set(m, way, 2);
+   }
+
+   static uint64_t victim(uint64_t *m, uint64_t assoc, uint64_t &state) {
+      uint64_t ones = (fields(assoc) & RRPV_ONES);
+      uint64_t x = m[0];
+      uint64_t distant = (x & (x >> 1) & ones);
+      if (!distant) {
+         // Age every way by 3 minus the largest RRPV.
+         uint64_t age = ((x & (ones << 1)) ? 1 : (x ? 2 : 3));
+         x += (age * ones);
+         m[0] = x;
+         distant = (x & (x >> 1) & ones);
+      }
+      return(__builtin_ctzll(distant) >> 1);
+   }
+};
+
+typedef repl_rrip_t<false> repl_srrip_t;
+typedef repl_rrip_t<true> repl_brrip_t;
+
+// Random replacement, from a per-cache xorshift generator (reproducible). No per-set state.
+struct repl_random_t {
+   static const uint64_t max_assoc = (1 << 16);
+   static const bool touch_mru_is_noop = true;
+   static uint64_t words(uint64_t assoc) { return(0); }
+
+   static void init(uint64_t *m, uint64_t assoc) {
+   }
+
+   static void touch(uint64_t *m, uint64_t assoc, uint64_t way) {
+   }
+
+   static void insert(uint64_t *m, uint64_t assoc, uint64_t way, uint64_t &state) {
+   }
+
+   static uint64_t victim(const uint64_t *m, uint64_t assoc, uint64_t &state) {
+      state ^= (state << 13);
+      state ^= (state >> 7);
+      state ^= (state << 17);
+      return(state % assoc);
+   }
+};
+
+#endif
@@ -23,6 +23,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include <inttypes.h>
+#include <string.h>
 #include <assert.h>
 #include "resource_schedule.h"
 
@@ -30,95 +31,111 @@ resource_schedule::resource_schedule(uint64_t width) {
    base_cycle = 0;
    this->width = width;
    depth = SCHED_DEPTH_INCREMENT;
-   sched = new uint64_t[depth];
-   for (uint64_t i = 0; i < depth; i++)
-      sched[i] = 0;
+   num_blocks = (depth >> SCHED_BLOCK_SHIFT);
+   sched = new uint32_t[depth];
+   full = new uint64_t[num_blocks];
+   gen = new uint64_t[num_blocks];
+   for (uint64_t i = 0; i < num_blocks; i++)
+      gen[i] = MAX_CYCLE;	// holds no block yet
 }
 
 resource_schedule::~resource_schedule() {
+   delete [] sched;
+   delete [] full;
+   delete [] gen;
 }
 
-void resource_schedule::resize(uint64_t new_depth) {
-   uint64_t old_depth;
-   uint64_t *old;
-   uint64_t increments;
-   uint64_t i;
-
-   old_depth = depth;
-   old = sched;
+// Double the ring until it reaches "block", keeping the live blocks (those at or after the base cycle's).
+void resource_schedule::resize(uint64_t block) {
+   uint32_t *old_sched = sched;
+   uint64_t *old_full = full;
+   uint64_t *old_gen = gen;
+   uint64_t old_num_blocks = num_blocks;
+   uint64_t base_block = (base_cycle >> SCHED_BLOCK_SHIFT);
+
+   while ((block - base_block) >= num_blocks)
+      num_blocks = (num_blocks << 1);
+   depth = (num_blocks << SCHED_BLOCK_SHIFT);
+
+   sched = new uint32_t[depth];
+   full = new uint64_t[num_blocks];
+   gen = new uint64_t[num_blocks];
+   for (uint64_t i = 0; i < num_blocks; i++)
+      gen[i] = MAX_CYCLE;
+   for (uint64_t i = 0; i < old_num_blocks; i++) {
+      if ((old_gen[i] != MAX_CYCLE) && (old_gen[i] >= base_block)) {
+         uint64_t j = (old_gen[i] & (num_blocks - 1));
+         gen[j] = old_gen[i];
+         full[j] = old_full[i];
+         memcpy(&sched[j << SCHED_BLOCK_SHIFT], &old_sched[i << SCHED_BLOCK_SHIFT], (sizeof(uint32_t) << SCHED_BLOCK_SHIFT));
+      }
+   }
 
-   increments = (new_depth/SCHED_DEPTH_INCREMENT);
-   if (new_depth % SCHED_DEPTH_INCREMENT)
-      increments++;
-   depth = increments*SCHED_DEPTH_INCREMENT;
-   assert(depth >= new_depth);
+   delete [] old_sched;
+   delete [] old_full;
+   delete [] old_gen;
+}
 
-   sched = new uint64_t[depth];
-   for (i = 0; i < old_depth; i++)
-      sched[i] = old[i];
-   for (i = old_depth; i < depth; i++)
-      sched[i] = 0;
+inline uint64_t resource_schedule::get_block(uint64_t block) {
+   if ((block - (base_cycle >> SCHED_BLOCK_SHIFT)) >= num_blocks)
+      resize(block);
+   uint64_t i = (block & (num_blocks - 1));
+   if (gen[i] != block) {
+      gen[i] = block;
+      full[i] = 0;
+      memset(&sched[i << SCHED_BLOCK_SHIFT], 0, (sizeof(uint32_t) << SCHED_BLOCK_SHIFT));
+   }
+   return(i);
+}
 
-   delete old;
+inline uint64_t resource_schedule::find(uint64_t start_cycle, uint64_t limit_cycle, uint64_t &i) {
+   uint64_t cycle = start_cycle;
+   while (cycle <= limit_cycle) {
+      uint64_t block = (cycle >> SCHED_BLOCK_SHIFT);
+      i = get_block(block);
+      uint64_t free_bits = (~full[i] & (~0ull << (cycle & 63)));
+      if (free_bits) {
+         cycle = ((block << SCHED_BLOCK_SHIFT) + __builtin_ctzll(free_bits));
+         return((cycle <= limit_cycle) ? cycle : MAX_CYCLE);
+      }
+      cycle = ((block + 1) << SCHED_BLOCK_SHIFT);
+   }
+   return(MAX_CYCLE);
 }
 
 uint64_t resource_schedule::schedule(uint64_t start_cycle, uint64_t max_delta) 
 {
    assert(start_cycle >= base_cycle);
 
-   uint64_t i;
-   uint64_t limit_cycle = max_delta == MAX_CYCLE ? MAX_CYCLE : start_cycle + max_delta;
-   bool found = false;
-
-   while (!found) {
-      if ((start_cycle - base_cycle + 1) > depth)
-         resize(start_cycle - base_cycle + 1);
-
-      if (sched[MOD_S(start_cycle,depth)] < width) {
-         found = true;
-         sched[MOD_S(start_cycle,depth)]++;
-      }
-      else {
-         start_cycle++;
-         if(start_cycle > limit_cycle)
-         {
-            return MAX_CYCLE;
-         }
-      }
+   // Common case: a lane is free in the start cycle.
+   uint64_t i = get_block(start_cycle >> SCHED_BLOCK_SHIFT);
+   uint32_t *n = &sched[(i << SCHED_BLOCK_SHIFT) | (start_cycle & 63)];
+   if (*n < width) {
+      if (++(*n) == width)
+         full[i] |= (1ull << (start_cycle & 63));
+      return(start_cycle);
    }
 
-   assert(found);
-   return(start_cycle);
+   uint64_t limit_cycle = max_delta == MAX_CYCLE ? MAX_CYCLE : start_cycle + max_delta;
+   uint64_t cycle = find(start_cycle, limit_cycle, i);
+   if (cycle == MAX_CYCLE)
+      return MAX_CYCLE;
+
+   if (++sched[(i << SCHED_BLOCK_SHIFT) | (cycle & 63)] == width)
+      full[i] |= (1ull << (cycle & 63));
+   return(cycle);
 }
 
 uint64_t resource_schedule::try_schedule(uint64_t try_cycle)
 {
    // Calling this assumes all previous events to schedule have been scheduled.
    assert(try_cycle >= base_cycle);
-
-   uint64_t i;;
-   bool found = false;
-
-   while (!found) {
-      if ((try_cycle - base_cycle + 1) > depth)
-         resize(try_cycle - base_cycle + 1);
-
-      if (sched[MOD_S(try_cycle,depth)] < width) {
-         found = true;
-      }
-      else {
-         try_cycle++;
-      }
-   }
-
-   assert(found);
-   return(try_cycle);
+   uint64_t i;
+   return(find(try_cycle, MAX_CYCLE, i));
 }
 
+// Cycles before the new base are never scheduled again: their blocks become stale as the base passes them.
 void resource_schedule::advance_base_cycle(uint64_t new_base_cycle) {
    assert(new_base_cycle >= base_cycle);
-   for (uint64_t i = base_cycle; i < new_base_cycle; i++)
-      sched[MOD_S(i,depth)] = 0;
    base_cycle = new_base_cycle;
 }
-
@@ -22,20 +22,35 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
 
-#define SCHED_DEPTH_INCREMENT 256
-#define MOD_S(x,y)		((x) & ((y)-1))
+#include <inttypes.h>
+
+// Schedule of a pool of identical lanes: the number of lanes used in each cycle from the
+// base cycle on, in a ring of occupancy counters. Cycles are grouped in blocks of 64, each
+// with a bitset of its full cycles, so the search for the first cycle with a free lane skips
+// 64 cycles per step with count-trailing-zeros. Each block is tagged with the block of cycles
+// it currently holds (its generation): a block whose tag is stale is cleared when it is next
+// touched, so advancing the base cycle costs nothing however far it moves, and the ring
+// doubles (keeping the live blocks) when the schedule reaches beyond it.
+
+#define SCHED_DEPTH_INCREMENT 256	// initial depth in cycles; a power of 2, multiple of 64
+#define SCHED_BLOCK_SHIFT	6	// 64 cycles per block: one bitset word
 
 constexpr uint64_t MAX_CYCLE = ~0lu;
 
 class resource_schedule {
 private:
-   uint64_t *sched;
-   uint64_t depth;
+   uint32_t *sched;	// lanes used in each cycle (ring)
+   uint64_t *full;	// per block: bit i set if cycle i of the block has no free lane
+   uint64_t *gen;	// per block: the block of cycles it holds (cycle >> SCHED_BLOCK_SHIFT)
+   uint64_t depth;	// cycles in the ring
+   uint64_t num_blocks;
    uint64_t width;
 
    uint64_t base_cycle;
 
-   void resize(uint64_t new_depth);
+   void resize(uint64_t block);
+   uint64_t get_block(uint64_t block);	// ring index of a block of cycles, cleared if stale
+   uint64_t find(uint64_t start_cycle, uint64_t limit_cycle, uint64_t &i);	// first cycle with a free lane (in block i of the ring), or MAX_CYCLE
 
 public:
    resource_schedule(uint64_t width);
@@ -43,4 +58,5 @@ public:
    uint64_t schedule(uint64_t start_cycle, uint64_t max_delta = MAX_CYCLE);
    uint64_t try_schedule(uint64_t try_cycle);
    void advance_base_cycle(uint64_t new_base_cycle);
+   uint64_t footprint() const { return(depth * sizeof(uint32_t) + num_blocks * 2 * sizeof(uint64_t)); }	// host memory of the schedule, in bytes
 };
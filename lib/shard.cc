@@ -0,0 +1,291 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include "cvp.h"
+#include "cvp_trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "trace_index.h"
+#include "shard.h"
+
+#define MIN(a, b) (((a) > (b)) ? (b) : (a))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+struct shard_t {
+   uint64_t start;	// first measured instruction
+   uint64_t warmup;	// instructions simulated before "start", excluded from measurements
+   uint64_t length;	// measured instructions
+   pid_t pid;
+   int fd;		// read end of the pipe from the shard's process
+   uarchsim_stats_t stats;
+   bool ok;
+};
+
+// Shards whose processes get SIGUSR1 forwarded (interim reports), while run_sharded() runs them.
+static std::vector<shard_t> *report_shards = (std::vector<shard_t> *)NULL;
+
+static void forward_report_request(int signum) {
+   for (uint64_t k = 0; k < report_shards->size(); k++) {
+      if ((*report_shards)[k].pid > 0)
+         kill((*report_shards)[k].pid, SIGUSR1);
+   }
+}
+
+// Send stdout to /dev/null, returning the descriptor to restore it with.
+static int mute_stdout() {
+   fflush(stdout);
+   int saved_fd = dup(STDOUT_FILENO);
+   int null_fd = open("/dev/null", O_WRONLY);
+   if (null_fd >= 0) {
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+   }
+   return(saved_fd);
+}
+
+static void unmute_stdout(int saved_fd) {
+   fflush(stdout);
+   if (saved_fd >= 0) {
+      dup2(saved_fd, STDOUT_FILENO);
+      close(saved_fd);
+   }
+}
+
+// Child process: simulate one shard and send its measurements to the parent.
+static void simulate_shard(const char *trace_name, const trace_index_t &index, const shard_t &s, const char *label, int fd, int pargc, char **pargv) {
+   // Only the parent reports, apart from interim reports: the predictor's output is discarded. An
+   // interim report is written at once, so that reports of concurrent shards do not interleave.
+   struct sigaction sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = request_interim_report;
+   sigemptyset(&sa.sa_mask);
+   sa.sa_flags = SA_RESTART;
+   sigaction(SIGUSR1, &sa, (struct sigaction *)NULL);
+   set_interim_report_label(label);
+   setvbuf(stdout, (char *)NULL, _IOFBF, (1 << 20));
+
+   SKIP_INSTS = (s.start - s.warmup);
+   WARMUP_INSTS = s.warmup;
+   MAX_INSTS = s.length;
+
+   uarchsim_stats_t stats;
+   {
+      CVPTraceReader reader(trace_name);
+      if (SKIP_INSTS)
+         trace_fast_forward(reader, trace_name, SKIP_INSTS, &index);
+
+      uarchsim_t *sim = new uarchsim_t;
+      int saved_fd = mute_stdout();
+      beginPredictor(pargc, pargv);
+      unmute_stdout(saved_fd);
+      uint64_t num_sim = 0;
+      while (simulate_inst(&reader, sim, num_sim))
+         ;
+      saved_fd = mute_stdout();
+      endPredictor();
+      unmute_stdout(saved_fd);
+      sim->get_stats(stats);
+   }
+
+   const char *p = (const char *)&stats;
+   uint64_t left = sizeof(stats);
+   while (left) {
+      ssize_t n = write(fd, p, left);
+      if (n <= 0)
+         _exit(1);
+      p += n;
+      left -= n;
+   }
+   close(fd);
+   fflush(stdout);
+   _exit(0);
+}
+
+static bool start_shard(const char *trace_name, const trace_index_t &index, shard_t &s, const char *label, int pargc, char **pargv) {
+   int fds[2];
+   if (pipe(fds) != 0)
+      return(false);
+
+   fflush(stdout);	// the child would otherwise inherit (and print) buffered output
+   s.pid = fork();
+   if (s.pid < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      return(false);
+   }
+   if (s.pid == 0) {
+      close(fds[0]);
+      simulate_shard(trace_name, index, s, label, fds[1], pargc, pargv);
+   }
+   close(fds[1]);
+   s.fd = fds[0];
+   return(true);
+}
+
+static void finish_shard(shard_t &s) {
+   char *p = (char *)&s.stats;
+   uint64_t left = sizeof(s.stats);
+   while (left) {
+      ssize_t n = read(s.fd, p, left);
+      if (n <= 0)
+         break;
+      p += n;
+      left -= n;
+   }
+   close(s.fd);
+
+   int status = 0;
+   pid_t pid = s.pid;
+   s.pid = 0;	// no more interim report requests: the process is done
+   waitpid(pid, &status, 0);
+   s.ok = ((left == 0) && WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+void run_sharded(const char *trace_name, uint64_t num_shards, uint64_t overlap, bool verify, int pargc, char **pargv) {
+   assert(num_shards > 0);
+
+   // The trace length comes from the index. Without a saved one (-x), it is built in memory
+   // and handed to the shard processes.
+   std::string index_name = std::string(trace_name) + ".idx";
+   trace_index_t index;
+   if (!index.load(index_name.c_str(), trace_name)) {
+      printf("Indexing trace %s (save the index with -x to skip this).\n", trace_name);
+      if (!index.build(trace_name)) {
+         printf("Error: could not index trace %s.\n", trace_name);
+         exit(1);
+      }
+   }
+
+   uint64_t begin = (SKIP_INSTS + WARMUP_INSTS);
+   uint64_t end = (MAX_INSTS ? MIN((begin + MAX_INSTS), index.size()) : index.size());
+   if (begin >= end) {
+      printf("Error: nothing to simulate (trace has %lu instructions).\n", index.size());
+      exit(1);
+   }
+
+   // Split the measured region into equal shards.
+   std::vector<shard_t> shards(num_shards + (verify ? 1 : 0));
+   for (uint64_t k = 0; k < num_shards; k++) {
+      shard_t &s = shards[k];
+      s.start = (begin + ((end - begin) * k)/num_shards);
+      s.length = ((begin + ((end - begin) * (k + 1))/num_shards) - s.start);
+      s.warmup = ((k == 0) ? WARMUP_INSTS : MIN(overlap, s.start));
+   }
+
+   // The serial reference is simulated alongside the shards.
+   if (verify) {
+      shard_t &s = shards[num_shards];
+      s.start = begin;
+      s.length = (end - begin);
+      s.warmup = WARMUP_INSTS;
+   }
+
+   // At most one process per host hardware thread. The serial reference is the longest, so it starts first.
+   uint64_t max_procs = MAX((uint64_t)std::thread::hardware_concurrency(), 1);
+   std::vector<uint64_t> order;
+   if (verify)
+      order.push_back(num_shards);
+   for (uint64_t k = 0; k < num_shards; k++)
+      order.push_back(k);
+   // Interim reports (SIGUSR1) come from the running shards.
+   struct sigaction sa, old_sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = forward_report_request;
+   sigemptyset(&sa.sa_mask);
+   sa.sa_flags = SA_RESTART;
+   report_shards = &shards;
+   sigaction(SIGUSR1, &sa, &old_sa);
+
+   for (uint64_t j = 0; j < order.size(); j++) {
+      if (j >= max_procs)
+         finish_shard(shards[order[j - max_procs]]);
+      char label[32];
+      if (order[j] == num_shards)
+         snprintf(label, sizeof(label), "serial reference");
+      else
+         snprintf(label, sizeof(label), "shard %lu", order[j]);
+      if (!start_shard(trace_name, index, shards[order[j]], label, pargc, pargv)) {
+         printf("Error: could not start shard %lu.\n", order[j]);
+         exit(1);
+      }
+   }
+   for (uint64_t j = ((order.size() > max_procs) ? (order.size() - max_procs) : 0); j < order.size(); j++)
+      finish_shard(shards[order[j]]);
+   sigaction(SIGUSR1, &old_sa, (struct sigaction *)NULL);
+   for (uint64_t k = 0; k < shards.size(); k++) {
+      if (!shards[k].ok) {
+         printf("Error: shard %lu failed.\n", k);
+         exit(1);
+      }
+   }
+
+   // Merged report.
+   uarchsim_t *sim = new uarchsim_t;
+   for (uint64_t k = 0; k < num_shards; k++)
+      sim->add_stats(shards[k].stats);
+   sim->output();
+
+   printf("SHARDS---------------------------------------------\n");
+   printf("shards    = %lu\n", num_shards);
+   printf("overlap   = %lu instructions\n", overlap);
+   printf("processes = %lu at a time\n", MIN(max_procs, (uint64_t)order.size()));
+   printf("Shard          start        warm-up   instructions         cycles    IPC\n");
+   for (uint64_t k = 0; k < num_shards; k++) {
+      const shard_t &s = shards[k];
+      printf("%5lu %14lu %14lu %14lu %14lu %6.3f\n", k, s.start, s.warmup, s.stats.num_inst, s.stats.cycle,
+             ((double)s.stats.num_inst/(double)s.stats.cycle));
+   }
+
+   if (verify) {
+      const uarchsim_stats_t &serial = shards[num_shards].stats;
+      double serial_ipc = ((double)serial.num_inst/(double)serial.cycle);
+      double merged_ipc = ((double)sim->get_measured_inst()/(double)sim->get_measured_cycles());
+      printf("Serial reference: instructions = %lu, cycles = %lu, IPC = %.3f\n", serial.num_inst, serial.cycle, serial_ipc);
+      double cycle_error = (((double)sim->get_measured_cycles() - (double)serial.cycle)/(double)serial.cycle);
+      double ipc_error = ((merged_ipc - serial_ipc)/serial_ipc);
+      printf("Sharding error:   cycles %+.3f%%, IPC %+.3f%%\n", 100.0*cycle_error, 100.0*ipc_error);
+      if ((fabs(cycle_error) > SHARD_ERROR_WARN) || (fabs(ipc_error) > SHARD_ERROR_WARN))
+         printf("Warning: sharding error exceeds %.1f%%: lengthen the overlap.\n", 100.0*SHARD_ERROR_WARN);
+   }
+
+   delete sim;
+}
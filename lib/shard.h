@@ -0,0 +1,50 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _SHARD_H_
+#define _SHARD_H_
+
+// Sharded simulation of one trace.
+//
+// The measured region of the trace (after SKIP_INSTS and WARMUP_INSTS, up to MAX_INSTS)
+// is split into K contiguous shards that are simulated in parallel. Each shard starts
+// "overlap" instructions early, from a cold machine, and simulates them as warm-up
+// (excluded from its measurements); the first shard starts where a serial run would.
+// The trace index (<trace>.idx if saved with -x, else built in memory and inherited by
+// the shard processes) lets each shard start near its region without decompressing the
+// trace from its start. At most one shard process per host hardware thread runs at a time.
+//
+// The value predictor interface keeps global state, so each shard runs in its own
+// process (fork()). Shards send their measurements (uarchsim_stats_t) back through a
+// pipe, and the parent adds them up into one report.
+
+// A serial reference run (verify) warns when the merged cycles or IPC are off by more than this.
+#define SHARD_ERROR_WARN	0.01
+
+// Simulate "trace_name" in "num_shards" shards with "overlap" warm-up instructions each.
+// If "verify" is set, also simulate the region serially and report the error of the
+// merged result. "pargc"/"pargv" are the value predictor's arguments.
+void run_sharded(const char *trace_name, uint64_t num_shards, uint64_t overlap, bool verify, int pargc, char **pargv);
+
+#endif
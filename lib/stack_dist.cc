@@ -0,0 +1,268 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+#include "cvp.h"
+#include "cvp_trace_reader.h"
+#include "parameters.h"
+#include "stack_dist.h"
+
+stack_dist_t::stack_dist_t(uint64_t blocksize) {
+   assert(blocksize && !(blocksize & (blocksize - 1)));
+   block_bits = __builtin_ctzll(blocksize);
+   tree.assign(STACK_DIST_MIN_SPAN + 1, 0);
+   now = 0;
+   mru_block = 0;
+   mru_valid = false;
+   reset_stats();
+}
+
+stack_dist_t::~stack_dist_t() {
+}
+
+void stack_dist_t::reset_stats() {
+   for (uint64_t b = 0; b < STACK_DIST_BUCKETS; b++)
+      hist[b] = 0;
+   refs = 0;
+   cold = 0;
+}
+
+void stack_dist_t::mark(uint64_t t, int32_t delta) {
+   for (uint64_t i = t + 1; i < tree.size(); i += (i & -i))
+      tree[i] += delta;
+}
+
+uint64_t stack_dist_t::prefix(uint64_t t) const {
+   uint64_t s = 0;
+   for (uint64_t i = t; i > 0; i -= (i & -i))
+      s += tree[i];
+   return(s);
+}
+
+// Renumber the latest references 0..n-1 in time order and rebuild the tree with room to grow.
+void stack_dist_t::compact() {
+   std::vector<std::pair<uint64_t, uint64_t *>> order;
+   order.reserve(last.size());
+   for (auto &e : last)
+      order.push_back(std::make_pair(e.second, &e.second));
+   std::sort(order.begin(), order.end());
+   for (uint64_t i = 0; i < order.size(); i++)
+      *(order[i].second) = i;
+
+   now = order.size();
+   tree.assign(std::max((uint64_t)(2 * now), (uint64_t)STACK_DIST_MIN_SPAN) + 1, 0);
+   // Times [0, now) are all marked: node i covers (i - lowbit(i), i].
+   for (uint64_t i = 1; i < tree.size(); i++) {
+      uint64_t lo = i - (i & -i);
+      tree[i] = ((now > lo) ? (std::min(i, now) - lo) : 0);
+   }
+}
+
+uint64_t stack_dist_t::bucket(uint64_t d) {
+   if (d < STACK_DIST_SUB)
+      return(d);
+   uint64_t o = 63 - __builtin_clzll(d);
+   return(STACK_DIST_SUB + ((o - STACK_DIST_SUB_BITS) * STACK_DIST_SUB) + ((d >> (o - STACK_DIST_SUB_BITS)) & (STACK_DIST_SUB - 1)));
+}
+
+uint64_t stack_dist_t::bucket_base(uint64_t b) {
+   if (b < STACK_DIST_SUB)
+      return(b);
+   uint64_t o = ((b - STACK_DIST_SUB) / STACK_DIST_SUB);
+   return((STACK_DIST_SUB + ((b - STACK_DIST_SUB) % STACK_DIST_SUB)) << o);
+}
+
+void stack_dist_t::access(uint64_t addr) {
+   uint64_t block = (addr >> block_bits);
+   refs++;
+
+   // Re-referencing the most recent block: distance 0, and its mark is already the latest.
+   if (mru_valid && (block == mru_block)) {
+      hist[0]++;
+      return;
+   }
+   mru_block = block;
+   mru_valid = true;
+
+   auto r = last.emplace(block, now);
+   if (r.second) {
+      cold++;
+   }
+   else {
+      uint64_t t = r.first->second;
+      hist[bucket(prefix(now) - prefix(t + 1))]++;
+      mark(t, -1);
+      r.first->second = now;
+   }
+   mark(now, 1);
+   now++;
+   if (now == (tree.size() - 1))
+      compact();
+}
+
+uint64_t stack_dist_t::misses(uint64_t blocks) const {
+   uint64_t m = cold;
+   for (uint64_t b = bucket(blocks); b < STACK_DIST_BUCKETS; b++)
+      m += hist[b];
+   return(m);
+}
+
+// P(X >= assoc) for X ~ Binomial(d, p).
+static double binomial_tail(uint64_t d, double p, uint64_t assoc) {
+   if (d < assoc)
+      return(0.0);
+   if (p >= 1.0)
+      return(1.0);
+   double pmf = exp((double)d * log1p(-p));
+   double cdf = 0.0;
+   for (uint64_t k = 0; k < assoc; k++) {
+      cdf += pmf;
+      pmf *= ((double)(d - k) / (double)(k + 1)) * (p / (1.0 - p));
+   }
+   return((cdf < 1.0) ? (1.0 - cdf) : 0.0);
+}
+
+double stack_dist_t::misses(uint64_t sets, uint64_t assoc) const {
+   double m = (double)cold;
+   for (uint64_t b = 0; b < STACK_DIST_BUCKETS; b++) {
+      if (hist[b]) {
+         // Representative distance: the bucket's midpoint (exact below STACK_DIST_SUB).
+         uint64_t d = ((b < STACK_DIST_SUB) ? b : ((bucket_base(b) + bucket_base(b + 1) - 1) / 2));
+         m += (double)hist[b] * binomial_tail(d, (1.0 / (double)sets), assoc);
+      }
+   }
+   return(m);
+}
+
+static const char *format_size(char *buf, uint64_t bytes) {
+   static const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+   uint64_t u = 0;
+   while ((bytes >= 1024) && !(bytes % 1024) && (u < 4)) {
+      bytes /= 1024;
+      u++;
+   }
+   sprintf(buf, "%lu %s", bytes, units[u]);
+   return(buf);
+}
+
+struct stack_dist_level_t {
+   const char *name;
+   uint64_t size;
+   uint64_t assoc;
+   uint64_t blocksize;
+   bool instr;
+   stack_dist_t *profile;
+};
+
+void stack_dist_profile(CVPTraceReader &reader) {
+   stack_dist_level_t levels[] = {
+      {"IC$", IC_SIZE, IC_ASSOC, IC_BLOCKSIZE, true, NULL},
+      {"L1$", L1_SIZE, L1_ASSOC, L1_BLOCKSIZE, false, NULL},
+      {"L2$", L2_SIZE, L2_ASSOC, L2_BLOCKSIZE, false, NULL},
+      {"L3$", L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, false, NULL},
+   };
+   const uint64_t num_levels = (sizeof(levels) / sizeof(levels[0]));
+
+   // One profile per reference stream and block size: levels with the same block size share it.
+   std::vector<stack_dist_t *> profiles;
+   std::vector<bool> profile_instr;
+   for (uint64_t l = 0; l < num_levels; l++) {
+      for (uint64_t j = 0; j < l; j++) {
+         if ((levels[j].instr == levels[l].instr) && (levels[j].blocksize == levels[l].blocksize))
+            levels[l].profile = levels[j].profile;
+      }
+      if (!levels[l].profile) {
+         levels[l].profile = new stack_dist_t(levels[l].blocksize);
+         profiles.push_back(levels[l].profile);
+         profile_instr.push_back(levels[l].instr);
+      }
+   }
+
+   // Same reference streams as the timing model: every micro-op's PC, loads, and stores if write-allocate.
+   db_t *inst;
+   uint64_t num_inst = 0;
+   while ((inst = reader.get_inst())) {
+      bool data = (inst->is_load || (inst->is_store && WRITE_ALLOCATE));
+      for (uint64_t p = 0; p < profiles.size(); p++) {
+         if (profile_instr[p])
+            profiles[p]->access(inst->pc);
+         else if (data)
+            profiles[p]->access(inst->addr);
+      }
+      delete inst;
+      num_inst++;
+
+      if (WARMUP_INSTS && (num_inst == WARMUP_INSTS)) {
+         for (uint64_t p = 0; p < profiles.size(); p++)
+            profiles[p]->reset_stats();
+      }
+      if (MAX_INSTS && (num_inst == (WARMUP_INSTS + MAX_INSTS)))
+         break;
+   }
+   if (WARMUP_INSTS && (num_inst >= WARMUP_INSTS))
+      num_inst -= WARMUP_INSTS;
+
+   char buf[32];
+   printf("STACK DISTANCE PROFILE (fully-associative LRU)-----\n");
+   printf("instructions = %lu\n", num_inst);
+   for (uint64_t p = 0; p < profiles.size(); p++) {
+      stack_dist_t *sd = profiles[p];
+      printf("%s references, %s blocks: %lu references, %lu distinct blocks, %lu cold misses\n",
+             (profile_instr[p] ? "Instruction" : (WRITE_ALLOCATE ? "Data (load and store)" : "Data (load)")),
+             format_size(buf, sd->blocksize()), sd->references(), sd->distinct_blocks(), sd->cold_misses());
+      printf("%12s %12s %10s %10s\n", "size", "misses", "miss ratio", "MPKI");
+      // Every power-of-two size, up to the first one that only takes cold misses.
+      for (uint64_t blocks = 1; ; blocks <<= 1) {
+         uint64_t m = sd->misses(blocks);
+         printf("%12s %12lu %9.2f%% %10.2f\n", format_size(buf, (blocks * sd->blocksize())), m,
+                (sd->references() ? (100.0 * (double)m / (double)sd->references()) : 0.0),
+                (num_inst ? (1000.0 * (double)m / (double)num_inst) : 0.0));
+         if (m == sd->cold_misses())
+            break;
+      }
+   }
+
+   printf("CONFIGURED CACHES (set-associative approximation)--\n");
+   printf("(L2$ and L3$ misses are global: references that hit in smaller caches are included.)\n");
+   printf("%-4s %-24s %12s %10s %12s %10s\n", "", "", "fully-assoc.", "MPKI", "set-assoc.", "MPKI");
+   for (uint64_t l = 0; l < num_levels; l++) {
+      stack_dist_level_t &lv = levels[l];
+      uint64_t fa = lv.profile->misses(lv.size / lv.blocksize);
+      double sa = lv.profile->misses((lv.size / (lv.assoc * lv.blocksize)), lv.assoc);
+      char desc[64];
+      char bsize[32];
+      snprintf(desc, sizeof(desc), "%s, %lu-way, %s", format_size(buf, lv.size), lv.assoc, format_size(bsize, lv.blocksize));
+      printf("%-4s %-24s %12lu %10.2f %12.0f %10.2f\n", lv.name, desc,
+             fa, (num_inst ? (1000.0 * (double)fa / (double)num_inst) : 0.0),
+             sa, (num_inst ? (1000.0 * sa / (double)num_inst) : 0.0));
+   }
+
+   for (uint64_t p = 0; p < profiles.size(); p++)
+      delete profiles[p];
+}
@@ -0,0 +1,98 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _STACK_DIST_H_
+#define _STACK_DIST_H_
+
+#include <vector>
+#include <unordered_map>
+
+// One-pass LRU stack-distance profiler (Mattson et al.).
+//
+// The stack distance of a reference is the number of distinct blocks referenced since the
+// previous reference to the same block. A fully-associative LRU cache of C blocks hits exactly
+// the references whose distance is below C, so one histogram of distances gives the miss ratio
+// of every cache size at once.
+//
+// Distances are counted with a Fenwick tree over reference times: each block marks only its
+// latest reference time, so the distance is the number of marks after it. The time axis is
+// compacted (renumbered by rank) whenever it fills, which keeps the tree proportional to the
+// number of distinct blocks and each reference O(log n).
+//
+// The histogram is log-linear: exact below STACK_DIST_SUB, then STACK_DIST_SUB buckets per
+// power of two. Power-of-two sizes fall on bucket boundaries, so their miss counts are exact.
+
+#define STACK_DIST_SUB_BITS	4
+#define STACK_DIST_SUB		(1 << STACK_DIST_SUB_BITS)
+#define STACK_DIST_BUCKETS	(STACK_DIST_SUB + ((64 - STACK_DIST_SUB_BITS) * STACK_DIST_SUB))
+#define STACK_DIST_MIN_SPAN	(1 << 16)	// smallest time axis
+
+class stack_dist_t {
+private:
+   uint64_t block_bits;
+   std::unordered_map<uint64_t, uint64_t> last;	// block -> time of its latest reference
+   std::vector<uint32_t> tree;			// Fenwick tree of latest-reference marks, indexed by time
+   uint64_t now;
+   uint64_t mru_block;
+   bool mru_valid;
+
+   uint64_t hist[STACK_DIST_BUCKETS];
+   uint64_t refs;
+   uint64_t cold;
+
+   void mark(uint64_t t, int32_t delta);
+   uint64_t prefix(uint64_t t) const;	// number of marks at times < t
+   void compact();
+
+   static uint64_t bucket(uint64_t d);
+   static uint64_t bucket_base(uint64_t b);	// smallest distance in bucket b
+
+public:
+   stack_dist_t(uint64_t blocksize);
+   ~stack_dist_t();
+
+   void access(uint64_t addr);
+   void reset_stats();	// keep the stack (warm-up), clear the histogram
+
+   uint64_t blocksize() const { return(1ULL << block_bits); }
+   uint64_t references() const { return(refs); }
+   uint64_t cold_misses() const { return(cold); }
+   uint64_t distinct_blocks() const { return(last.size()); }
+
+   // Misses of a fully-associative LRU cache of "blocks" blocks (a power of two).
+   uint64_t misses(uint64_t blocks) const;
+
+   // Approximate misses of a set-associative LRU cache: the blocks referenced between two
+   // references to a block are assumed to spread uniformly over the sets, so the reference
+   // misses if at least "assoc" of its "d" intervening blocks map to its set (binomial model).
+   double misses(uint64_t sets, uint64_t assoc) const;
+};
+
+struct CVPTraceReader;
+
+// Profile the data and instruction reference streams of the rest of the trace, then print
+// miss-ratio curves and the configured caches' approximate misses. Honors -W and -N.
+void stack_dist_profile(CVPTraceReader &reader);
+
+#endif
@@ -49,6 +49,18 @@ static std::ostream& operator<<(std::ostream& stream, const PrefetcherState& s)
     return stream;
 }
 
+// Prefetcher measurements, for combining the results of separately simulated regions.
+struct PrefetcherStats
+{
+    uint64_t trainings;
+    uint64_t generated;
+    uint64_t issued;
+    uint64_t duplicate_pf_filtered;
+    uint64_t dropped_untimely_pf;
+    uint64_t put_back;
+    uint64_t stride_zero;
+};
+
 constexpr uint64_t NUM_RPT_ENTRIES = 1024;
 constexpr uint64_t PREFETCH_MULTIPLIER = 2; // 2 because when we lookahead, we are 1 behind, so need next(next(access))
 constexpr int PF_QUEUE_SIZE = 32;
@@ -354,6 +366,40 @@ class StridePrefetcher
         }
     }
 
+    void reset_stats()
+    {
+        stat_trainings = 0;
+        stat_generated = 0;
+        stat_issued = 0;
+        stat_duplicate_pf_filtered = 0;
+        stat_dropped_untimely_pf = 0;
+        stat_put_back = 0;
+        stat_stride_zero = 0;
+    }
+
+    PrefetcherStats get_stats() const
+    {
+        return {stat_trainings, stat_generated, stat_issued, stat_duplicate_pf_filtered,
+                stat_dropped_untimely_pf, stat_put_back, stat_stride_zero};
+    }
+
+    void add_stats(const PrefetcherStats& s)
+    {
+        stat_trainings += s.trainings;
+        stat_generated += s.generated;
+        stat_issued += s.issued;
+        stat_duplicate_pf_filtered += s.duplicate_pf_filtered;
+        stat_dropped_untimely_pf += s.dropped_untimely_pf;
+        stat_put_back += s.put_back;
+        stat_stride_zero += s.stride_zero;
+    }
+
+    // Host memory of the prefetcher (reference prediction table and prefetch queue), in bytes.
+    uint64_t footprint() const
+    {
+        return sizeof(*this) + queue.size() * sizeof(Prefetch);
+    }
+
     void print_stats()
     {
         std::cout << "Num Trainings :" << std::dec << stat_trainings  <<std::endl;
@@ -354,13 +354,35 @@ public:
 #endif
   int THRES;
 
+  // Host memory of the predictor (this object and the tables it allocates), in bytes.
+  uint64_t footprint() const {
+    uint64_t bytes = sizeof(*this) +
+                     ((uint64_t)(NBANKLOW + NBANKHIGH) * (1 << LOGG) * sizeof(gentry)) +
+                     ((1 << LOGB) * sizeof(bentry));
+#ifdef LOOPPREDICTOR
+    bytes += ((1 << LOGL) * sizeof(lentry));
+#endif
+    return bytes;
+  }
+
   PREDICTOR(void) {
+    // Written as a zero-initialized global: many histories and tables are not
+    // set by reinit(), so zero them here for heap (per-core, per-thread) instances.
+    memset((void *)this, 0, sizeof(*this));
 
     reinit();
 #ifdef PRINTSIZE
     predictorsize();
 #endif
   }
+  ~PREDICTOR(void) {
+#ifdef LOOPPREDICTOR
+    arena_delete(ltable, (1 << (LOGL)), ARENA_HOT);
+#endif
+    arena_delete(gtable[1], (NBANKLOW * (1 << LOGG)), ARENA_HOT);
+    arena_delete(gtable[BORN], (NBANKHIGH * (1 << LOGG)), ARENA_HOT);
+    arena_delete(btable, (1 << LOGB), ARENA_HOT);
+  }
   int predictorsize() {
     int STORAGESIZE = 0;
     int inter = 0;
@@ -474,20 +496,20 @@ public:
     }
 
 #ifdef LOOPPREDICTOR
-    ltable = new lentry[1 << (LOGL)];
+    ltable = arena_new<lentry>((1 << (LOGL)), ARENA_HOT);
 #endif
 
-    gtable[1] = new gentry[NBANKLOW * (1 << LOGG)];
+    gtable[1] = arena_new<gentry>((NBANKLOW * (1 << LOGG)), ARENA_HOT);
     SizeTable[1] = NBANKLOW * (1 << LOGG);
 
-    gtable[BORN] = new gentry[NBANKHIGH * (1 << LOGG)];
+    gtable[BORN] = arena_new<gentry>((NBANKHIGH * (1 << LOGG)), ARENA_HOT);
     SizeTable[BORN] = NBANKHIGH * (1 << LOGG);
 
     for (int i = BORN + 1; i <= NHIST; i++)
       gtable[i] = gtable[BORN];
     for (int i = 2; i <= BORN - 1; i++)
       gtable[i] = gtable[1];
-    btable = new bentry[1 << LOGB];
+    btable = arena_new<bentry>((1 << LOGB), ARENA_HOT);
 
     for (int i = 1; i <= NHIST; i++) {
       ch_i[i].init(m[i], (logg[i]));
@@ -0,0 +1,59 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _TIMESTAMP_H_
+#define _TIMESTAMP_H_
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Cycle timestamps of the timing structures (register file, store queue, window and caches)
+// are stored as 32-bit offsets from an epoch base, which halves the footprint of the hottest
+// arrays. Every timestamp written is at or after its structure's base.
+//
+// Before offsets can overflow, the owner rebases: it moves the base forward to a cycle that
+// no later lookup or update precedes, and subtracts the difference from every stored offset
+// in one sweep, clamping earlier timestamps to the new base. A clamped timestamp compares the
+// same as the original against any cycle at or after the new base, so results stay exact.
+
+typedef uint32_t stamp_t;
+
+#define STAMP_REBASE_DISTANCE	(1ull << 31)	// rebase once the base lags this many cycles behind
+
+static inline stamp_t to_stamp(uint64_t cycle, uint64_t base) {
+   assert((cycle >= base) && ((cycle - base) <= UINT32_MAX));
+   return((stamp_t)(cycle - base));
+}
+
+static inline uint64_t from_stamp(stamp_t stamp, uint64_t base) {
+   return(base + stamp);
+}
+
+// Offset relative to a base that moved forward by "delta" cycles.
+static inline stamp_t rebase_stamp(stamp_t stamp, uint64_t delta) {
+   return((stamp > delta) ? (stamp_t)(stamp - delta) : 0);
+}
+
+#endif
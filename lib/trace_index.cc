@@ -0,0 +1,327 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <zlib.h>
+#include <sys/stat.h>
+#include <string>
+#include "cvp.h"
+#include "cvp_trace_reader.h"
+#include "trace_index.h"
+
+#define TRACE_INDEX_CHUNK	16384
+#define TRACE_INDEX_MAGIC	"CVPTIDX2"
+
+// Size and modification time of a trace file, identifying the version of it an index describes.
+static bool trace_identity(const char *trace_name, uint64_t &size, uint64_t &mtime) {
+   struct stat st;
+   if (stat(trace_name, &st) != 0)
+      return(false);
+   size = (uint64_t)st.st_size;
+   mtime = (((uint64_t)st.st_mtim.tv_sec * 1000000000ull) + (uint64_t)st.st_mtim.tv_nsec);
+   return(true);
+}
+
+// Stream buffer that resumes raw inflation of a gzip trace at an access point.
+class trace_index_streambuf : public std::streambuf {
+private:
+   FILE *file;
+   z_stream strm;
+   bool done;
+   unsigned char in[TRACE_INDEX_CHUNK];
+   char out[TRACE_INDEX_CHUNK];
+
+public:
+   trace_index_streambuf(const char *trace_name, const trace_index_point_t &p) {
+      memset(&strm, 0, sizeof(strm));
+      done = true;
+
+      file = fopen(trace_name, "rb");
+      if (!file)
+         return;
+      if (inflateInit2(&strm, -15) != Z_OK)	// raw deflate: the gzip header is behind us
+         return;
+      if (fseeko(file, (off_t)(p.in - (p.bits ? 1 : 0)), SEEK_SET) != 0)
+         return;
+      if (p.bits) {
+         int c = getc(file);
+         if (c == EOF)
+            return;
+         inflatePrime(&strm, p.bits, c >> (8 - p.bits));
+      }
+      inflateSetDictionary(&strm, p.window, TRACE_INDEX_WINSIZE);
+      done = false;
+   }
+
+   ~trace_index_streambuf() {
+      inflateEnd(&strm);
+      if (file)
+         fclose(file);
+   }
+
+protected:
+   int_type underflow() {
+      if (gptr() < egptr())
+         return traits_type::to_int_type(*gptr());
+
+      strm.next_out = (Bytef *)out;
+      strm.avail_out = sizeof(out);
+      while (!done && (strm.avail_out == sizeof(out))) {
+         if (strm.avail_in == 0) {
+            strm.avail_in = fread(in, 1, sizeof(in), file);
+            strm.next_in = in;
+            if (strm.avail_in == 0) {
+               done = true;
+               break;
+            }
+         }
+         int ret = inflate(&strm, Z_NO_FLUSH);
+         if ((ret != Z_OK) && (ret != Z_BUF_ERROR))
+            done = true;	// Z_STREAM_END (the gzip trailer follows) or a data error
+      }
+
+      setg(out, out, (char *)strm.next_out);
+      if (gptr() == egptr())
+         return traits_type::eof();
+      return traits_type::to_int_type(*gptr());
+   }
+};
+
+class trace_index_istream : public std::istream {
+private:
+   trace_index_streambuf buf;
+
+public:
+   trace_index_istream(const char *trace_name, const trace_index_point_t &p)
+      : std::istream(NULL), buf(trace_name, p) {
+      init(&buf);
+   }
+};
+
+trace_index_t::trace_index_t() {
+   num_uop = 0;
+   trace_size = 0;
+   trace_mtime = 0;
+}
+
+trace_index_t::~trace_index_t() {
+}
+
+bool trace_index_t::build(const char *trace_name, uint64_t span) {
+   points.clear();
+   num_uop = 0;
+   if (!trace_identity(trace_name, trace_size, trace_mtime))
+      return(false);
+
+   // Pass 1: find access points at deflate block boundaries (after zlib's zran example).
+   FILE *file = fopen(trace_name, "rb");
+   if (!file)
+      return(false);
+
+   z_stream strm;
+   memset(&strm, 0, sizeof(strm));
+   if (inflateInit2(&strm, 47) != Z_OK) {	// 47: detect gzip or zlib header
+      fclose(file);
+      return(false);
+   }
+
+   unsigned char *in = new unsigned char[TRACE_INDEX_CHUNK];
+   unsigned char *window = new unsigned char[TRACE_INDEX_WINSIZE];
+   uint64_t totin = 0;
+   uint64_t totout = 0;
+   uint64_t last = 0;
+   int ret = Z_OK;
+
+   strm.avail_out = 0;
+   do {
+      strm.avail_in = fread(in, 1, TRACE_INDEX_CHUNK, file);
+      strm.next_in = in;
+      if (strm.avail_in == 0) {
+         ret = Z_DATA_ERROR;	// premature end of file
+         break;
+      }
+
+      do {
+         if (strm.avail_out == 0) {
+            strm.avail_out = TRACE_INDEX_WINSIZE;
+            strm.next_out = window;
+         }
+
+         totin += strm.avail_in;
+         totout += strm.avail_out;
+         ret = inflate(&strm, Z_BLOCK);
+         totin -= strm.avail_in;
+         totout -= strm.avail_out;
+
+         if ((ret == Z_NEED_DICT) || (ret == Z_MEM_ERROR) || (ret == Z_DATA_ERROR)) {
+            ret = Z_DATA_ERROR;
+            break;
+         }
+         if (ret == Z_STREAM_END)
+            break;
+
+         // At the end of a deflate block (but not the last one), consider adding an access point.
+         if ((strm.data_type & 128) && !(strm.data_type & 64) && (totout == 0 || (totout - last) > span)) {
+            points.emplace_back();
+            trace_index_point_t &p = points.back();
+            uint64_t left = strm.avail_out;
+
+            p.in = totin;
+            p.out = totout;
+            p.bits = (strm.data_type & 7);
+            if (left)
+               memcpy(p.window, window + TRACE_INDEX_WINSIZE - left, left);
+            if (left < TRACE_INDEX_WINSIZE)
+               memcpy(p.window + left, window, TRACE_INDEX_WINSIZE - left);
+            last = totout;
+         }
+      } while (strm.avail_in != 0);
+   } while ((ret != Z_STREAM_END) && (ret != Z_DATA_ERROR));
+
+   inflateEnd(&strm);
+   fclose(file);
+   delete [] in;
+   delete [] window;
+
+   if (ret != Z_STREAM_END) {
+      points.clear();
+      return(false);
+   }
+
+   // Pass 2: tie each access point to the first instruction boundary at or after it.
+   CVPTraceReader reader(trace_name);
+   uint64_t next = 0;
+   while (true) {
+      if (!reader.mRemainingPieces) {
+         while ((next < points.size()) && (points[next].out <= reader.nBytes)) {
+            points[next].boundary = reader.nBytes;
+            points[next].uop = num_uop;
+            points[next].instr = reader.nInstr;
+            next++;
+         }
+      }
+      if (!reader.skip(1))
+         break;
+      num_uop++;
+   }
+
+   // Access points past the last instruction are useless.
+   points.resize(next);
+   return(true);
+}
+
+bool trace_index_t::save(const char *index_name) const {
+   FILE *fp = fopen(index_name, "wb");
+   if (!fp)
+      return(false);
+
+   uint64_t n = points.size();
+   bool ok = (fwrite(TRACE_INDEX_MAGIC, 8, 1, fp) == 1) &&
+             (fwrite(&trace_size, sizeof(trace_size), 1, fp) == 1) &&
+             (fwrite(&trace_mtime, sizeof(trace_mtime), 1, fp) == 1) &&
+             (fwrite(&num_uop, sizeof(num_uop), 1, fp) == 1) &&
+             (fwrite(&n, sizeof(n), 1, fp) == 1) &&
+             ((n == 0) || (fwrite(&points[0], sizeof(trace_index_point_t), n, fp) == n));
+   fclose(fp);
+   return(ok);
+}
+
+bool trace_index_t::load(const char *index_name, const char *trace_name) {
+   FILE *fp = fopen(index_name, "rb");
+   if (!fp)
+      return(false);
+
+   char magic[8];
+   uint64_t n = 0;
+   bool ok = (fread(magic, 8, 1, fp) == 1) && !memcmp(magic, TRACE_INDEX_MAGIC, 8) &&
+             (fread(&trace_size, sizeof(trace_size), 1, fp) == 1) &&
+             (fread(&trace_mtime, sizeof(trace_mtime), 1, fp) == 1) &&
+             (fread(&num_uop, sizeof(num_uop), 1, fp) == 1) &&
+             (fread(&n, sizeof(n), 1, fp) == 1);
+
+   // An index of another trace, or of an earlier version of this one, would resume
+   // decompression with the wrong dictionary.
+   uint64_t size, mtime;
+   if (ok && (!trace_identity(trace_name, size, mtime) || (size != trace_size) || (mtime != trace_mtime))) {
+      fprintf(stderr, "Warning: trace index %s does not match %s (rebuild it with -x); ignoring it.\n", index_name, trace_name);
+      ok = false;
+   }
+   if (ok) {
+      points.resize(n);
+      ok = ((n == 0) || (fread(&points[0], sizeof(trace_index_point_t), n, fp) == n));
+   }
+   fclose(fp);
+
+   if (!ok) {
+      points.clear();
+      num_uop = 0;
+   }
+   return(ok);
+}
+
+uint64_t trace_index_t::seek(CVPTraceReader &reader, const char *trace_name, uint64_t uop) const {
+   // Find the latest access point whose instruction boundary does not pass "uop".
+   uint64_t lo = 0;
+   uint64_t hi = points.size();
+   while (lo < hi) {
+      uint64_t mid = (lo + hi) / 2;
+      if (points[mid].uop <= uop)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   if (lo == 0)
+      return(0);
+
+   const trace_index_point_t &p = points[lo - 1];
+   if (p.uop == 0)
+      return(0);	// nothing to gain over decoding from the start
+
+   trace_index_istream *input = new trace_index_istream(trace_name, p);
+   input->ignore((std::streamsize)(p.boundary - p.out));
+   if (!input->good()) {
+      delete input;
+      return(0);
+   }
+
+   reader.reposition(input, p.instr, p.boundary);
+   return(p.uop);
+}
+
+void trace_fast_forward(CVPTraceReader &reader, const char *trace_name, uint64_t num_uop, const trace_index_t *index) {
+   uint64_t skipped = 0;
+   if (index) {
+      skipped = index->seek(reader, trace_name, num_uop);
+   }
+   else {
+      std::string index_name = std::string(trace_name) + ".idx";
+      trace_index_t file_index;
+      if (file_index.load(index_name.c_str(), trace_name))
+         skipped = file_index.seek(reader, trace_name, num_uop);
+   }
+   reader.skip(num_uop - skipped);
+}
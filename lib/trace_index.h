@@ -0,0 +1,90 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+#ifndef _TRACE_INDEX_H_
+#define _TRACE_INDEX_H_
+
+#include <vector>
+
+// Random-access index for a gzip-compressed trace.
+//
+// A gzip stream can only be decompressed from its start. The index records
+// access points at deflate block boundaries (compressed offset, uncompressed
+// offset and the 32KB dictionary that precedes the block), in the manner of
+// zlib's "zran" example. Each access point is tied to the first trace
+// instruction that starts at or after it, along with the number of
+// micro-instructions that precede that instruction. Fast-forwarding to
+// micro-instruction N then only decompresses from the nearest access point.
+//
+// The index for "trace.gz" is kept in "trace.gz.idx". It records the size and
+// modification time of the trace it was built from, and is not used for a trace
+// that no longer matches them.
+
+#define TRACE_INDEX_WINSIZE	32768	// deflate dictionary size
+#define TRACE_INDEX_SPAN	(1 << 23)	// uncompressed bytes between access points
+
+struct trace_index_point_t {
+   uint64_t in;		// compressed byte offset of the access point
+   uint64_t out;	// uncompressed byte offset of the access point
+   uint64_t boundary;	// uncompressed offset of the first instruction starting at or after "out"
+   uint64_t uop;	// number of micro-instructions before "boundary"
+   uint64_t instr;	// number of trace instructions before "boundary"
+   uint32_t bits;	// number of bits of the byte at "in - 1" that belong to the block
+   uint8_t window[TRACE_INDEX_WINSIZE];	// dictionary for resuming decompression
+};
+
+struct CVPTraceReader;
+
+class trace_index_t {
+private:
+   std::vector<trace_index_point_t> points;
+   uint64_t num_uop;	// total number of micro-instructions in the trace
+   uint64_t trace_size;	// size (bytes) and modification time (ns) of the indexed trace
+   uint64_t trace_mtime;
+
+public:
+   trace_index_t();
+   ~trace_index_t();
+
+   // Scan the whole trace and record access points. Returns false on a decompression error.
+   bool build(const char *trace_name, uint64_t span = TRACE_INDEX_SPAN);
+
+   // Load an index of "trace_name". Fails if there is none, or if the trace changed since
+   // the index was built (with a warning on stderr).
+   bool load(const char *index_name, const char *trace_name);
+   bool save(const char *index_name) const;
+
+   // Reposition the reader at the latest indexed instruction boundary that does not pass
+   // micro-instruction "uop". Returns the number of micro-instructions skipped, which is
+   // at most "uop": the caller decodes the remainder.
+   uint64_t seek(CVPTraceReader &reader, const char *trace_name, uint64_t uop) const;
+
+   uint64_t size() const { return(num_uop); }
+   uint64_t num_points() const { return(points.size()); }
+};
+
+// Fast-forward "reader" past "num_uop" micro-instructions, using "index" if given,
+// else "<trace_name>.idx" if present.
+void trace_fast_forward(CVPTraceReader &reader, const char *trace_name, uint64_t num_uop, const trace_index_t *index = NULL);
+
+#endif
@@ -26,22 +26,33 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <inttypes.h>
 #include <assert.h>
+#include <signal.h>
 #include "cvp.h"
 #include "cvp_trace_reader.h"
 #include "fifo.h"
 #include "cache.h"
+#include "arena.h"
 #include "bp.h"
 #include "resource_schedule.h"
 #include "uarchsim.h"
 #include "parameters.h"
+#include "profiler.h"
+#include "pipeview.h"
+#include "bp_ahead.h"
+#include "bp_sidecar.h"
 
 //uarchsim_t::uarchsim_t():window(WINDOW_SIZE),
-uarchsim_t::uarchsim_t():BP(20,16,20,16,64),window(WINDOW_SIZE),
-			 L3(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL),
-			 L2(L2_SIZE, L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY, &L3),
-			 L1(L1_SIZE, L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY, &L2),
-                         IC(IC_SIZE, IC_ASSOC, IC_BLOCKSIZE, 0, &L2) {
+uarchsim_t::uarchsim_t(shared_cache_port_t *llc, bool bp_tables):BP(20,16,20,16,64,bp_tables),window(WINDOW_SIZE),
+			 L3(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL, L3_REPL, L3_MSHRS, ARENA_COLD),
+			 L2(L2_SIZE, L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY, (llc ? (cache_t *)NULL : &L3), L2_REPL, L2_MSHRS, ARENA_WARM),
+			 L1(L1_SIZE, L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY, &L2, L1_REPL, L1_MSHRS, ARENA_HOT),
+                         IC(IC_SIZE, IC_ASSOC, IC_BLOCKSIZE, 0, &L2, IC_REPL, IC_MSHRS, ARENA_HOT) {
    assert(WINDOW_SIZE);
+
+   this->llc = llc;
+   this->bp_tables = bp_tables;
+   if (llc)
+      L2.set_shared_next(llc);
    //assert(FETCH_WIDTH);
 
    //setup logger
@@ -51,16 +62,34 @@ uarchsim_t::uarchsim_t():BP(20,16,20,16,64),window(WINDOW_SIZE),
 
    ldst_lanes = ((NUM_LDST_LANES > 0) ? (new resource_schedule(NUM_LDST_LANES)) : ((resource_schedule *)NULL));
    alu_lanes = ((NUM_ALU_LANES > 0) ? (new resource_schedule(NUM_ALU_LANES)) : ((resource_schedule *)NULL));
+   fu_pools = (FU_POOLS ? (new fu_pools_t(FU_POOLS)) : ((fu_pools_t *)NULL));
 
+   epoch = 0;
    for (int i = 0; i < RFSIZE; i++)
       RF[i] = 0;
+   memset(RF_path, 0, sizeof(RF_path));
+
+   retire_batch = new RetireInfo[WINDOW_SIZE];
+
+   sq_prune_at = SQ_PRUNE_MIN;
+   sq_peak = 0;
 
    num_fetched = 0;
    num_fetched_branch = 0;
    fetch_cycle = 0;
+   memset(&fetch_path, 0, sizeof(fetch_path));
+   piece = 0;
+   prev_pc = 0xdeadbeef;
+   last_ic_block = 0;
+   ic_block_valid = false;
 
    num_inst = 0;
    cycle = 0;
+   memset(&cycle_path, 0, sizeof(cycle_path));
+   stats_inst_base = 0;
+   stats_cycle_base = 0;
+   for (int i = 0; i < CPI_NUM_REASONS; i++)
+      cpi_stack[i] = 0;
  
    // CVP measurements
    num_eligible = 0;
@@ -70,15 +99,316 @@ uarchsim_t::uarchsim_t():BP(20,16,20,16,64),window(WINDOW_SIZE),
    // stats
    num_load = 0;
    num_load_sqmiss = 0;
+
+   interval_stats = (INTERVAL_INSTS ? (new interval_writer_t(INTERVAL_STATS_FILE)) : ((interval_writer_t *)NULL));
+   pipeview = (PIPEVIEW_FILE ? (new pipeview_writer_t(PIPEVIEW_FILE)) : ((pipeview_writer_t *)NULL));
+   oracle = (ORACLE_FILE ? (new oracle_t(ORACLE_FILE)) : ((oracle_t *)NULL));
+   if (oracle)
+      BP.set_perfect_pcs(&oracle->bp);
+   live_stats = (LIVE_STATS_FILE ? (new live_stats_t(LIVE_STATS_FILE)) : ((live_stats_t *)NULL));
+   convergence = (CONVERGENCE_INTERVAL ? (new convergence_t(CONVERGENCE_REL_ERR, CONVERGENCE_METRICS)) : ((convergence_t *)NULL));
 }
 
 uarchsim_t::~uarchsim_t() {
+   if (interval_stats)
+      delete interval_stats;
+   if (pipeview)
+      delete pipeview;
+   if (live_stats)
+      delete live_stats;
+   if (oracle)
+      delete oracle;
+   if (fu_pools)
+      delete fu_pools;
+   if (convergence)
+      delete convergence;
+   delete [] retire_batch;
+}
+
+void uarchsim_t::reset_stats() {
+   // num_inst also provides sequence numbers to the value predictor, so it keeps counting.
+   stats_inst_base = num_inst;
+   stats_cycle_base = cycle;
+   for (int i = 0; i < CPI_NUM_REASONS; i++)
+      cpi_stack[i] = 0;
+
+   // CVP measurements
+   num_eligible = 0;
+   num_correct = 0;
+   num_incorrect = 0;
+
+   // stats
+   num_load = 0;
+   num_load_sqmiss = 0;
+   stat_pfs_issued_to_mem = 0;
+
+   IC.reset_stats();
+   L1.reset_stats();
+   L2.reset_stats();
+   if (llc)
+      llc->reset_stats();
+   else
+      L3.reset_stats();
+   BP.reset_stats();
+   prefetcher.reset_stats();
+   if (fu_pools)
+      fu_pools->reset_stats();
+
+   if (interval_stats)
+      interval_stats->reset();
+   if (convergence)
+      convergence->reset();
+}
+
+void uarchsim_t::get_stats(uarchsim_stats_t &s) const {
+   s.num_inst = (num_inst - stats_inst_base);
+   s.cycle = (cycle - stats_cycle_base);
+   for (int i = 0; i < CPI_NUM_REASONS; i++)
+      s.cpi_stack[i] = cpi_stack[i];
+   s.num_eligible = num_eligible;
+   s.num_correct = num_correct;
+   s.num_incorrect = num_incorrect;
+   s.num_load = num_load;
+   s.num_load_sqmiss = num_load_sqmiss;
+   s.pfs_issued_to_mem = stat_pfs_issued_to_mem;
+   s.sq_peak = ((sq_peak > SQ.size()) ? sq_peak : SQ.size());
+   s.ic = IC.get_stats();
+   s.l1 = L1.get_stats();
+   s.l2 = L2.get_stats();
+   s.l3 = (llc ? llc->get_stats() : L3.get_stats());
+   s.bp = BP.get_stats();
+   s.pf = prefetcher.get_stats();
+   if (fu_pools)
+      fu_pools->get_stats(s.fu);
+}
+
+// Measured instructions and cycles add up, as if the regions ran back to back.
+void uarchsim_t::add_stats(const uarchsim_stats_t &s) {
+   num_inst += s.num_inst;
+   cycle += s.cycle;
+   for (int i = 0; i < CPI_NUM_REASONS; i++)
+      cpi_stack[i] += s.cpi_stack[i];
+   num_eligible += s.num_eligible;
+   num_correct += s.num_correct;
+   num_incorrect += s.num_incorrect;
+   num_load += s.num_load;
+   num_load_sqmiss += s.num_load_sqmiss;
+   stat_pfs_issued_to_mem += s.pfs_issued_to_mem;
+   if (s.sq_peak > sq_peak)
+      sq_peak = s.sq_peak;
+   IC.add_stats(s.ic);
+   L1.add_stats(s.l1);
+   L2.add_stats(s.l2);
+   if (llc)
+      llc->add_stats(s.l3);
+   else
+      L3.add_stats(s.l3);
+   BP.add_stats(s.bp);
+   prefetcher.add_stats(s.pf);
+   if (fu_pools)
+      fu_pools->add_stats(s.fu);
+}
+
+// Default for value predictors that do not report their memory: unknown.
+__attribute__((weak)) uint64_t predictorFootprint() {
+   return(0);
+}
+
+// Default for value predictors that do not define updatePredictorBatch(): one updatePredictor() call per
+// micro-instruction. A predictor's own (strong) definition takes precedence at link time.
+__attribute__((weak)) void updatePredictorBatch(const RetireInfo *retired, size_t n) {
+   for (size_t i = 0; i < n; i++)
+      updatePredictor(retired[i].seq_no, retired[i].actual_addr, retired[i].actual_value, retired[i].actual_latency);
+}
+
+static volatile sig_atomic_t interim_report_requested = 0;
+static const char *interim_report_label = NULL;
+
+void request_interim_report(int signum) {
+   interim_report_requested = 1;
+}
+
+bool take_interim_report_request() {
+   if (!interim_report_requested)
+      return(false);
+   interim_report_requested = 0;
+   return(true);
+}
+
+void set_interim_report_label(const char *label) {
+   interim_report_label = label;
+}
+
+bool simulate_inst(CVPTraceReader *reader, uarchsim_t *sim, uint64_t &num_sim, bp_ahead_t *ahead, bp_sidecar_t *sidecar) {
+   bool raw_misp = false;
+   PROF_BEGIN(PROF_DECODE);
+   db_t *inst = (ahead ? ahead->get_inst(raw_misp) : reader->get_inst());
+   PROF_END(PROF_DECODE);
+   if (!inst)
+      return(false);
+
+   // Outcomes predicted ahead or taken from the sidecar: apply oracle overrides here, measure in step().
+   bool br_misp = false;
+   if (sidecar) {
+      if (sidecar->is_loaded()) {
+         raw_misp = sidecar->next();
+      }
+      else {
+         if (!ahead)
+            raw_misp = sim->get_bp()->train_raw((InstClass) inst->insn, inst->pc, inst->next_pc);
+         sidecar->record(raw_misp);
+      }
+   }
+   if (ahead || sidecar)
+      br_misp = sim->get_bp()->override((InstClass) inst->insn, inst->pc, raw_misp);
+
+   sim->step(inst, ((ahead || sidecar) ? &br_misp : (const bool *)NULL));
+   delete inst;
+   num_sim++;
+
+   // End of warm-up: measurements cover only what follows.
+   if (WARMUP_INSTS && (num_sim == WARMUP_INSTS))
+      sim->reset_stats();
+
+   if (MAX_INSTS && (num_sim == (WARMUP_INSTS + MAX_INSTS)))
+      return(false);
+
+   // Early termination: the measured metrics have converged.
+   if (sim->converged())
+      return(false);
+
+   if (!sim->is_core() && take_interim_report_request()) {
+      printf("INTERIM REPORT (%s%s%lu instructions simulated)=====================================\n",
+             (interim_report_label ? interim_report_label : ""), (interim_report_label ? ", " : ""), num_sim);
+      sim->output();
+      printf("END OF INTERIM REPORT=========================================================\n");
+      fflush(stdout);
+   }
+   return(true);
+}
+
+void uarchsim_t::interval_sample() {
+   interval_counters_t c;
+   get_interval_counters(c);
+   interval_stats->sample(c);
+}
+
+void uarchsim_t::get_interval_counters(interval_counters_t &c) const {
+   c.inst = (num_inst - stats_inst_base);
+   c.cycle = (cycle - stats_cycle_base);
+   c.bp_inst = BP.get_num_inst();
+   c.bp_misp = BP.get_num_misp();
+   c.l1_accesses = L1.get_accesses();
+   c.l1_misses = L1.get_misses();
+   c.l2_accesses = L2.get_accesses();
+   c.l2_misses = L2.get_misses();
+   c.l3_accesses = (llc ? llc->get_accesses() : L3.get_accesses());
+   c.l3_misses = (llc ? llc->get_misses() : L3.get_misses());
+   c.pf_issued = stat_pfs_issued_to_mem;
+   c.vp_correct = num_correct;
+   c.vp_incorrect = num_incorrect;
+}
+
+void uarchsim_t::close_interval_stats() {
+   if (interval_stats) {
+      if ((num_inst > WARMUP_INSTS) && ((num_inst - stats_inst_base) % INTERVAL_INSTS))
+         interval_sample();
+      interval_stats->close();
+   }
+}
+
+void uarchsim_t::close_pipeview() {
+   if (pipeview)
+      pipeview->close();
+}
+
+void uarchsim_t::live_update(live_state_t state) {
+   interval_counters_t c;
+   get_interval_counters(c);
+   live_stats->update(state, num_inst, c);
+}
+
+void uarchsim_t::close_live_stats() {
+   if (live_stats)
+      live_update(LIVE_FINISHED);
 }
 
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define MIN(a, b) (((a) > (b)) ? (b) : (a))
 
-PredictionRequest uarchsim_t::get_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst)
+// Rebase the timestamps of the RF, SQ, window and caches. No later lookup or update precedes
+// "new_epoch": see get_stamp_floor().
+void uarchsim_t::rebase(uint64_t new_epoch) {
+   assert(new_epoch >= epoch);
+   uint64_t delta = (new_epoch - epoch);
+   for (int i = 0; i < RFSIZE; i++)
+      RF[i] = rebase_stamp(RF[i], delta);
+   for (auto it = SQ.begin(); it != SQ.end(); ++it) {
+      it->second.exec_cycle = rebase_stamp(it->second.exec_cycle, delta);
+      it->second.ret_cycle = rebase_stamp(it->second.ret_cycle, delta);
+   }
+   for (uint64_t i = 0; i < window.get_length(); i++)
+      window.at(i).retire_cycle = rebase_stamp(window.at(i).retire_cycle, delta);
+   epoch = new_epoch;
+
+   IC.rebase(new_epoch);
+   L1.rebase(new_epoch);
+   L2.rebase(new_epoch);
+   L3.rebase(new_epoch);	// the shared L3 (multi-core mode) is rebased by its owner
+}
+
+// A load executes after its fetch cycle, and fetch_cycle never decreases, so an entry that
+// committed by now can never hit again (see the SQ search in step()).
+void uarchsim_t::prune_sq() {
+   sq_peak = MAX(sq_peak, (uint64_t)SQ.size());
+   for (auto it = SQ.begin(); it != SQ.end(); ) {
+      if (from_stamp(it->second.ret_cycle, epoch) <= fetch_cycle)
+         it = SQ.erase(it);
+      else
+         ++it;
+   }
+   sq_prune_at = MAX(SQ_PRUNE_MIN, (2 * SQ.size()));
+}
+
+// Advance the simulation cycle to "until" (if later), whose critical path is "path".
+inline void uarchsim_t::charge_cycle(uint64_t until, const cpi_path_t &path) {
+   if (until > cycle) {
+      for (int i = 0; i < CPI_NUM_REASONS; i++)
+         cpi_stack[i] += (int64_t)(int32_t)(path.c[i] - cycle_path.c[i]);
+      cycle_path = path;
+      cycle = until;
+   }
+}
+
+// Stall fetch until "until" (if later), charging the stall to "reason" on the fetch path.
+inline void uarchsim_t::redirect_fetch(uint64_t until, cpi_reason_t reason) {
+   if (until > fetch_cycle) {
+      fetch_path.c[reason] += (until - fetch_cycle);
+      fetch_cycle = until;
+   }
+}
+
+// Stall fetch until the window's head retires at "until", whose critical path is "head". The
+// stall is charged to CPI_WINDOW. The cycles before it follow the head's path, less the cycles
+// that path runs ahead of the fetch path, taken from its latest categories (loads first).
+inline void uarchsim_t::stall_fetch_on_window(uint64_t until, const cpi_path_t &head) {
+   uint64_t stall = (until - fetch_cycle);
+   cpi_path_t path = head;
+   for (int i = (CPI_NUM_REASONS - 1); (i >= 0) && (stall > 0); i--) {
+      int32_t ahead = (int32_t)(path.c[i] - fetch_path.c[i]);
+      if (ahead > 0) {
+         ahead = MIN((uint64_t)ahead, stall);
+         path.c[i] -= ahead;
+         stall -= ahead;
+      }
+   }
+   assert(stall == 0);
+   path.c[CPI_WINDOW] += (until - fetch_cycle);
+   fetch_path = path;
+   fetch_cycle = until;
+}
+
+PredictionRequest uarchsim_t::get_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst, cache_lookup_t *path)
 {
    PredictionRequest req;
    req.seq_no = seq_no;
@@ -100,19 +430,22 @@ PredictionRequest uarchsim_t::get_prediction_req_for_track(uint64_t cycle, uint6
      
          if(req.is_candidate)
          {
-            req.cache_hit = HitMissInfo::Miss;
-            uint64_t exec_cycle = get_load_exec_cycle(inst);
-            if(L1.is_hit(exec_cycle, inst->addr))
+            // One walk of the hierarchy; the load's own accesses reuse its lookups.
+            uint64_t exec_cycle = get_load_exec_cycle(cycle);
+            switch (L1.hit_level(exec_cycle, inst->addr, path))
             {
+            case 1:
                req.cache_hit = HitMissInfo::L1DHit;
-            }
-            else if(L2.is_hit(exec_cycle, inst->addr))
-            {
+               break;
+            case 2:
                req.cache_hit = HitMissInfo::L2Hit;
-            }
-            else if(L3.is_hit(exec_cycle, inst->addr))
-            {
+               break;
+            case 3:
                req.cache_hit = HitMissInfo::L3Hit;
+               break;
+            default:
+               req.cache_hit = HitMissInfo::Miss;
+               break;
             }
          }
          break;
@@ -124,25 +457,9 @@ PredictionRequest uarchsim_t::get_prediction_req_for_track(uint64_t cycle, uint6
    return req;
 }
 
-uint64_t uarchsim_t::get_load_exec_cycle(db_t *inst) const
+uint64_t uarchsim_t::get_load_exec_cycle(uint64_t ready_cycle) const
 {
-   uint64_t exec_cycle = fetch_cycle;
-
-   // No need to re-access ICache because fetch_cycle has already been updated    
-   exec_cycle = exec_cycle + PIPELINE_FILL_LATENCY;
-
-   if (inst->A.valid) {
-      assert(inst->A.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->A.log_reg]);
-   }
-   if (inst->B.valid) {
-      assert(inst->B.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->B.log_reg]);
-   }
-   if (inst->C.valid) {
-      assert(inst->C.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->C.log_reg]);
-   }
+   uint64_t exec_cycle = ready_cycle;
 
    if (ldst_lanes) exec_cycle = ldst_lanes->try_schedule(exec_cycle);
 
@@ -152,13 +469,11 @@ uint64_t uarchsim_t::get_load_exec_cycle(db_t *inst) const
    return exec_cycle;
 }
 
-void uarchsim_t::step(db_t *inst) 
+void uarchsim_t::step(db_t *inst, const bool *br_misp_ahead) 
 {
    spdlog::debug("Stepping, FC: {}",fetch_cycle);
 
    // Preliminary step: determine which piece of the instruction this is.
-   static uint8_t piece = 0;
-   static uint64_t prev_pc = 0xdeadbeef;
    piece = ((inst->pc == prev_pc) ? (piece + 1) : 0);
    prev_pc = inst->pc;
 
@@ -166,11 +481,24 @@ void uarchsim_t::step(db_t *inst)
    /////////////////////////////
    // Manage window: retire.
    /////////////////////////////
-   while (!window.empty() && (fetch_cycle >= window.peekhead().retire_cycle)) {
+   PROF_BEGIN(PROF_RETIRE);
+   uint64_t num_retired = 0;
+   stamp_t retired_cycle = 0;
+   while (!window.empty() && (fetch_cycle >= from_stamp(window.peekhead().retire_cycle, epoch))) {
       window_t w = window.pop();
-      if (VP_ENABLE && !VP_PERFECT)
-         updatePredictor(w.seq_no, w.addr, w.value, w.latency);
+      if (VP_ENABLE && !VP_PERFECT) {
+         // Notify the value predictor once per retire cycle.
+         if (num_retired && (w.retire_cycle != retired_cycle)) {
+            updatePredictorBatch(retire_batch, num_retired);
+            num_retired = 0;
+         }
+         retire_batch[num_retired++] = {w.seq_no, w.addr, w.value, w.latency};
+         retired_cycle = w.retire_cycle;
+      }
    }
+   if (num_retired)
+      updatePredictorBatch(retire_batch, num_retired);
+   PROF_END(PROF_RETIRE);
  
    // CVP variables
    uint64_t seq_no = num_inst;
@@ -185,22 +513,71 @@ void uarchsim_t::step(db_t *inst)
    uint64_t addr;
    uint64_t exec_cycle;
 
-   if (FETCH_MODEL_ICACHE)
-      fetch_cycle = IC.access(fetch_cycle, true, inst->pc);   // Note: I-cache hit latency is "0" (above), so fetch cycle doesn't increase on hits.
+   PROF_BEGIN(PROF_ICACHE);
+   if (FETCH_MODEL_ICACHE) {
+      // One I$ lookup per run of instructions in the same block: the block stays MRU and already
+      // available (fetch_cycle never decreases), so a repeated lookup cannot change the fetch cycle,
+      // nor the replacement state unless the policy promotes a block on its first hit (RRIP).
+      uint64_t ic_block = IC.block(inst->pc);
+      if (ic_block_valid && (ic_block == last_ic_block) && IC.repeat_hit_is_noop()) {
+         IC.count_repeat_hit();
+      }
+      else {
+         uint64_t ic_cycle = IC.access(fetch_cycle, true, inst->pc);   // Note: I-cache hit latency is "0" (above), so fetch cycle doesn't increase on hits.
+         redirect_fetch(ic_cycle, CPI_ICACHE);
+         last_ic_block = ic_block;
+         ic_block_valid = true;
+      }
+   }
+   PROF_END(PROF_ICACHE);
+
+   PROF_BEGIN(PROF_OPERANDS);
+   exec_cycle = fetch_cycle + PIPELINE_FILL_LATENCY;
+   const cpi_path_t *src_path = NULL;	// CPI stack: the latest source register's path, if it sets the issue cycle
+
+   if (inst->A.valid) {
+      assert(inst->A.log_reg < RFSIZE);
+      if (from_stamp(RF[inst->A.log_reg], epoch) > exec_cycle) src_path = &RF_path[inst->A.log_reg];
+      exec_cycle = MAX(exec_cycle, from_stamp(RF[inst->A.log_reg], epoch));
+   }
+   if (inst->B.valid) {
+      assert(inst->B.log_reg < RFSIZE);
+      if (from_stamp(RF[inst->B.log_reg], epoch) > exec_cycle) src_path = &RF_path[inst->B.log_reg];
+      exec_cycle = MAX(exec_cycle, from_stamp(RF[inst->B.log_reg], epoch));
+   }
+   if (inst->C.valid) {
+      assert(inst->C.log_reg < RFSIZE);
+      if (from_stamp(RF[inst->C.log_reg], epoch) > exec_cycle) src_path = &RF_path[inst->C.log_reg];
+      exec_cycle = MAX(exec_cycle, from_stamp(RF[inst->C.log_reg], epoch));
+   }
+
+   // Critical path to the completion cycle, starting with the issue cycle.
+   cpi_path_t path;
+   if (src_path) {
+      path = *src_path;
+   }
+   else {
+      path = fetch_path;
+      path.c[CPI_BASE] += PIPELINE_FILL_LATENCY;
+   }
+
+   PROF_END(PROF_OPERANDS);
 
    // Predict at fetch time
+   PROF_BEGIN(PROF_VP);
+   cache_lookup_t load_path[CACHE_MAX_LEVELS];	// lookups of a load's block, reused by its L1$ access
    if (VP_ENABLE)
    {
       if (VP_PERFECT)
       {
-         PredictionRequest req = get_prediction_req_for_track(fetch_cycle, seq_no, piece, inst);
+         PredictionRequest req = get_prediction_req_for_track(exec_cycle, seq_no, piece, inst, load_path);
          pred.predicted_value = inst->D.value;
          pred.speculate = predictable && req.is_candidate;
          predictable &= req.is_candidate;
       }
       else
       {
-         PredictionRequest req = get_prediction_req_for_track(fetch_cycle, seq_no, piece, inst);
+         PredictionRequest req = get_prediction_req_for_track(exec_cycle, seq_no, piece, inst, load_path);
          pred = getPrediction(req);
          speculativeUpdate(seq_no, predictable, ((predictable && pred.speculate && req.is_candidate) ? ((pred.predicted_value == inst->D.value) ? 1 : 0) : 2),
                            inst->pc, inst->next_pc, (InstClass)inst->insn, piece,
@@ -216,31 +593,35 @@ void uarchsim_t::step(db_t *inst)
    else {
       pred.speculate = false;
    }
- 
-   exec_cycle = fetch_cycle + PIPELINE_FILL_LATENCY;
 
-   if (inst->A.valid) {
-      assert(inst->A.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->A.log_reg]);
-   }
-   if (inst->B.valid) {
-      assert(inst->B.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->B.log_reg]);
-   }
-   if (inst->C.valid) {
-      assert(inst->C.log_reg < RFSIZE);
-      exec_cycle = MAX(exec_cycle, RF[inst->C.log_reg]);
+   // Oracle override: the listed PCs are predicted perfectly, with or without a value predictor.
+   if (oracle && predictable && oracle->vp.contains(inst->pc)) {
+      pred.predicted_value = inst->D.value;
+      pred.speculate = true;
    }
+   PROF_END(PROF_VP);
+ 
 
    //
    // Schedule an execution lane.
    //
+   PROF_BEGIN(PROF_LANES);
+   uint64_t ready_cycle = exec_cycle;
+   fu_pool_t *pool = (fu_pools ? fu_pools->get(inst->insn) : (fu_pool_t *)NULL);
    if (inst->is_load || inst->is_store) {
       if (ldst_lanes) exec_cycle = ldst_lanes->schedule(exec_cycle);
    }
+   else if (pool) {
+      exec_cycle = fu_pools->schedule(pool, exec_cycle, fetch_cycle);
+   }
    else {
       if (alu_lanes) exec_cycle = alu_lanes->schedule(exec_cycle);
    }
+   path.c[CPI_LANE] += (exec_cycle - ready_cycle);
+   PROF_END(PROF_LANES);
+
+   uint64_t issue_cycle = exec_cycle;
+   cpi_reason_t load_reason = CPI_SQ;	// CPI stack: what set a load's completion after issue
 
    if (inst->is_load) {
      
@@ -249,6 +630,8 @@ void uarchsim_t::step(db_t *inst)
       // AGEN takes 1 cycle.
       exec_cycle = (exec_cycle + 1);
 
+      PROF_BEGIN(PROF_DCACHE);
+
       // Train the prefetcher when the load finds out its outcome in the L1D
       if (PREFETCHER_ENABLE)
       {
@@ -257,27 +640,35 @@ void uarchsim_t::step(db_t *inst)
          prefetcher.lookahead((inst->pc >> 2), fetch_cycle);
 
          // Train the prefetcher 
-         const bool hit = L1.is_hit(exec_cycle, inst->addr);
+         if (!load_path[0].valid)
+            L1.lookup(inst->addr, load_path[0]);
+         const bool hit = L1.is_hit(exec_cycle, load_path[0]);
          PrefetchTrainingInfo info{inst->pc >> 2, inst->addr, 0, hit};
          prefetcher.train(info);
       }
 
       // Search D$ using AGEN's cycle.
       uint64_t data_cache_cycle;
-      if (PERFECT_CACHE)
+      uint64_t data_cache_level = 1;
+      if (PERFECT_CACHE || (oracle && oracle->l1.contains(inst->pc)))
          data_cache_cycle = exec_cycle + L1_LATENCY;
       else
-         data_cache_cycle = L1.access(exec_cycle, true, inst->addr);
+         data_cache_cycle = L1.access(exec_cycle, true, inst->addr, false, &data_cache_level, load_path);
+
+      PROF_END(PROF_DCACHE);
 
       // Search of SQ takes 1 cycle after AGEN cycle.
       exec_cycle = (exec_cycle + 1);
 
+      PROF_BEGIN(PROF_SQ);
+
       bool inc_sqmiss = false;
       uint64_t temp_cycle = 0;
       for (i = 0, addr = inst->addr; i < inst->size; i++, addr++) {
-         if ((SQ.find(addr) != SQ.end()) && (exec_cycle < SQ[addr].ret_cycle)) {
+         auto sq = SQ.find(addr);
+         if ((sq != SQ.end()) && (exec_cycle < from_stamp(sq->second.ret_cycle, epoch))) {
             // SQ hit: the byte's timestamp is the later of load's execution cycle and store's execution cycle
-            temp_cycle = MAX(temp_cycle, MAX(exec_cycle, SQ[addr].exec_cycle));
+            temp_cycle = MAX(temp_cycle, MAX(exec_cycle, from_stamp(sq->second.exec_cycle, epoch)));
          }
          else {
             // SQ miss: the byte's timestamp is its availability in L1 D$
@@ -286,18 +677,31 @@ void uarchsim_t::step(db_t *inst)
          }
       }
 
+      PROF_END(PROF_SQ);
+
       num_load++;					// stat
       num_load_sqmiss += (inc_sqmiss ? 1 : 0);		// stat
 
       assert(temp_cycle >= exec_cycle);
       exec_cycle = temp_cycle;
 
+      // The load waited for the data cache if any byte missed in the SQ and the cache was the last to deliver.
+      if (inc_sqmiss && (exec_cycle == data_cache_cycle))
+         load_reason = ((data_cache_level == 1) ? CPI_L1 : ((data_cache_level == 2) ? CPI_L2 : ((data_cache_level == 3) ? CPI_L3 : CPI_MEM)));
+
       latency = (exec_cycle - latency);	// end of execution minus start of execution
       assert(latency >= 2);	// 2 cycles if all bytes hit in SQ
+
+      // CPI stack: AGEN plus an L1 hit is execution latency, the rest waited on the memory level or store.
+      uint64_t hit_latency = MIN(latency, (1 + L1_LATENCY));
+      path.c[CPI_EXEC] += hit_latency;
+      path.c[load_reason] += (latency - hit_latency);
    }
    else {
-      // Determine the fixed execution latency based on ALU type.
-      if (inst->insn == InstClass::fpInstClass)
+      // Determine the execution latency: the pool's, or fixed based on ALU type.
+      if (pool)
+         latency = pool->latency;
+      else if (inst->insn == InstClass::fpInstClass)
          latency = 3;
       else if (inst->insn == InstClass::slowAluInstClass)
          latency = 4;
@@ -306,12 +710,14 @@ void uarchsim_t::step(db_t *inst)
 
       // Account for execution latency.
       exec_cycle += latency;
+      path.c[CPI_EXEC] += latency;
    }
 
    // Drain prefetches from PF Queue
    // The idea is that a prefetch can go only if there is a free LDST slot "this" cycle
    // Here, "this" means all the cycles between the previous fetch cycle and the current one since all fetched ld/st will have been
    // scheduled and prefetch can correctly "steal" ld/st slots.
+   PROF_BEGIN(PROF_PREFETCH);
    if(PREFETCHER_ENABLE)
    {
       uint64_t tmp_previous_fetch_cycle;
@@ -349,10 +755,11 @@ void uarchsim_t::step(db_t *inst)
          }
       }
    }
+   PROF_END(PROF_PREFETCH);
 
    // Update the instruction count and simulation cycle (max. completion cycle among all scheduled instructions).
    num_inst += 1;
-   cycle = MAX(cycle, exec_cycle);
+   charge_cycle(exec_cycle, path);
 
    // Update destination register timestamp.
    if (inst->D.valid) {
@@ -360,25 +767,31 @@ void uarchsim_t::step(db_t *inst)
       if (inst->D.log_reg != RFFLAGS) 
       {
          squash = (pred.speculate && (pred.predicted_value != inst->D.value));         
-         RF[inst->D.log_reg] = ((pred.speculate && (pred.predicted_value == inst->D.value)) ? fetch_cycle : exec_cycle);
+         RF[inst->D.log_reg] = to_stamp(((pred.speculate && (pred.predicted_value == inst->D.value)) ? fetch_cycle : exec_cycle), epoch);
+         RF_path[inst->D.log_reg] = ((pred.speculate && (pred.predicted_value == inst->D.value)) ? fetch_path : path);
       }
    }
 
    // Update SQ byte timestamps.
+   PROF_BEGIN(PROF_SQ);
+   uint64_t store_cycle = 0;
    if (inst->is_store) {
       uint64_t data_cache_cycle;
-      if (!WRITE_ALLOCATE || PERFECT_CACHE)
+      if (!WRITE_ALLOCATE || PERFECT_CACHE || (oracle && oracle->l1.contains(inst->pc)))
          data_cache_cycle = exec_cycle;
       else
-         data_cache_cycle = L1.access(exec_cycle, true, inst->addr);
+         data_cache_cycle = L1.access(exec_cycle, false, inst->addr);
 
       // uint64_t ret_cycle = MAX(exec_cycle, (window.empty() ? 0 : window.peektail().retire_cycle));
-      uint64_t ret_cycle = MAX(data_cache_cycle, (window.empty() ? 0 : window.peektail().retire_cycle));
-      for (i = 0, addr = inst->addr; i < inst->size; i++, addr++) {
-         SQ[addr].exec_cycle = exec_cycle;
-         SQ[addr].ret_cycle = ret_cycle;
-      }
+      uint64_t ret_cycle = MAX(data_cache_cycle, (window.empty() ? 0 : from_stamp(window.peektail().retire_cycle, epoch)));
+      store_queue_t entry = {to_stamp(exec_cycle, epoch), to_stamp(ret_cycle, epoch)};
+      for (i = 0, addr = inst->addr; i < inst->size; i++, addr++)
+         SQ[addr] = entry;
+      store_cycle = ret_cycle;
+      if (SQ.size() >= sq_prune_at)
+         prune_sq();
    }
+   PROF_END(PROF_SQ);
 
    // CVP measurements
    num_eligible += (predictable ? 1 : 0);
@@ -388,11 +801,16 @@ void uarchsim_t::step(db_t *inst)
    /////////////////////////////
    // Manage window: dispatch.
    /////////////////////////////
-   window.push({MAX(exec_cycle, (window.empty() ? 0 : window.peektail().retire_cycle)),
+   PROF_BEGIN(PROF_FETCH);
+   uint64_t retire_cycle = MAX(exec_cycle, (window.empty() ? 0 : from_stamp(window.peektail().retire_cycle, epoch)));
+   if (retire_cycle > exec_cycle)	// in-order retirement: the critical path runs through the previous instruction
+      path = window.peektail().retire_path;
+   window.push({to_stamp(retire_cycle, epoch),
+               (uint32_t)latency,
                seq_no,
                ((inst->is_load || inst->is_store) ? inst->addr : 0xDEADBEEF),
                ((inst->D.valid && (inst->D.log_reg != RFFLAGS)) ? inst->D.value : 0xDEADBEEF),
-	       latency});
+               path});
 
    /////////////////////////////
    // Manage fetch cycle.
@@ -401,13 +819,13 @@ void uarchsim_t::step(db_t *inst)
 
    if (squash) {			// control dependency on the retire cycle of the value-mispredicted instruction
       num_fetched = 0;			// new fetch bundle
-      assert(!window.empty() && (fetch_cycle < window.peektail().retire_cycle));
-      fetch_cycle = window.peektail().retire_cycle;
+      assert(!window.empty() && (fetch_cycle < from_stamp(window.peektail().retire_cycle, epoch)));
+      redirect_fetch(from_stamp(window.peektail().retire_cycle, epoch), CPI_VP_SQUASH);
    }
    else if (window.full()) {
-      if (fetch_cycle < window.peekhead().retire_cycle) {
+      if (fetch_cycle < from_stamp(window.peekhead().retire_cycle, epoch)) {
          num_fetched = 0;		// new fetch bundle
-         fetch_cycle = window.peekhead().retire_cycle;
+         stall_fetch_on_window(from_stamp(window.peekhead().retire_cycle, epoch), window.peekhead().retire_path);
       }
    }
    else {				// fetch bundle constraints
@@ -442,20 +860,78 @@ void uarchsim_t::step(db_t *inst)
          // new fetch bundle
          num_fetched = 0;
 	 num_fetched_branch = 0;
-         fetch_cycle++;
+         redirect_fetch((fetch_cycle + 1), CPI_FETCH_BW);
       }
    }
 
+   PROF_END(PROF_FETCH);
+
    // Account for the effect of a mispredicted branch on the fetch cycle.
-   if (!PERFECT_BRANCH_PRED && BP.predict((InstClass) inst->insn, inst->pc, inst->next_pc))
-      fetch_cycle = MAX(fetch_cycle, exec_cycle);
+   PROF_BEGIN(PROF_BP);
+   bool br_misp;
+   if (PERFECT_BRANCH_PRED) {
+      br_misp = false;
+   }
+   else if (br_misp_ahead) {
+      br_misp = *br_misp_ahead;
+      BP.measure((InstClass) inst->insn, br_misp);
+   }
+   else {
+      br_misp = BP.predict((InstClass) inst->insn, inst->pc, inst->next_pc);
+   }
+   if (br_misp)
+      redirect_fetch(exec_cycle, CPI_BRANCH);
+   PROF_END(PROF_BP);
 
    spdlog::debug("Updating base_cycle to {}", MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
 
    // Attempt to advance the base cycles of resource schedules.
    // Note : We may have some prefetches to issue still that are older than the fetch cycle.
-   if (ldst_lanes) ldst_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
-   if (alu_lanes) alu_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
+   PROF_BEGIN(PROF_ADVANCE);
+   uint64_t base_cycle = MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle());
+   if (ldst_lanes) ldst_lanes->advance_base_cycle(base_cycle);
+   if (alu_lanes) alu_lanes->advance_base_cycle(base_cycle);
+   IC.prune(base_cycle);	// the caches' MSHR and memory bus timelines
+   L1.prune(base_cycle);
+   L2.prune(base_cycle);
+   L3.prune(base_cycle);
+
+   // Rebase the 32-bit timestamps well before they can overflow.
+   if ((previous_fetch_cycle - epoch) >= STAMP_REBASE_DISTANCE)
+      rebase(previous_fetch_cycle);
+   PROF_END(PROF_ADVANCE);
+
+   // Pipeline view of the selected region.
+   if (pipeview && (seq_no >= PIPEVIEW_START) && ((seq_no - PIPEVIEW_START) < PIPEVIEW_COUNT)) {
+      pipeview_record_t r;
+      r.seq_no = seq_no;
+      r.pc = inst->pc;
+      r.addr = inst->addr;
+      r.fetch_cycle = previous_fetch_cycle;
+      r.issue_cycle = issue_cycle;
+      r.complete_cycle = exec_cycle;
+      r.retire_cycle = retire_cycle;
+      r.store_cycle = store_cycle;
+      r.insn = inst->insn;
+      r.piece = piece;
+      r.size = inst->size;
+      r.vp_squash = squash;
+      r.br_misp = br_misp;
+      pipeview->record(r);
+   }
+
+   // Interval measurements start after warm-up.
+   if (interval_stats && (num_inst > WARMUP_INSTS) && (((num_inst - stats_inst_base) % INTERVAL_INSTS) == 0))
+      interval_sample();
+
+   if (convergence && (num_inst > WARMUP_INSTS) && (((num_inst - stats_inst_base) % CONVERGENCE_INTERVAL) == 0)) {
+      interval_counters_t c;
+      get_interval_counters(c);
+      convergence->sample(c);
+   }
+
+   if (live_stats && ((num_inst & (LIVE_STATS_PERIOD - 1)) == 0))
+      live_update((num_inst > WARMUP_INSTS) ? LIVE_MEASURING : LIVE_WARMUP);
 
    // DEBUG
    //printf("%d,%d\n", num_inst, cycle);
@@ -466,6 +942,22 @@ void uarchsim_t::step(db_t *inst)
 #define SCALED_SIZE(size)	((size/KILOBYTE >= KILOBYTE) ? (size/MEGABYTE) : (size/KILOBYTE))
 #define SCALED_UNIT(size)	((size/KILOBYTE >= KILOBYTE) ? "MB" : "KB")
 
+static const char *cpi_reason_names[CPI_NUM_REASONS] = {
+   "Pipeline fill",
+   "Fetch bandwidth",
+   "I$ miss",
+   "Execution latency",
+   "Value mispred. squash",
+   "Branch mispred.",
+   "Window full",
+   "Lane contention",
+   "Load: L1$",
+   "Load: L2$",
+   "Load: L3$",
+   "Load: main memory",
+   "Load: SQ forwarding",
+};
+
 void uarchsim_t::output() {
    auto get_track_name = [] (uint64_t track){
       static std::string track_names [] = {
@@ -487,9 +979,18 @@ void uarchsim_t::output() {
    printf("FETCH_MODEL_ICACHE = %s\n", (FETCH_MODEL_ICACHE ? "1" : "0"));
    printf("PERFECT_BRANCH_PRED = %s\n", (PERFECT_BRANCH_PRED ? "1" : "0"));
    printf("PERFECT_INDIRECT_PRED = %s\n", (PERFECT_INDIRECT_PRED ? "1" : "0"));
+   if (oracle)
+      printf("ORACLE_FILE = %s (PC ranges: %lu vp, %lu l1, %lu bp)\n", ORACLE_FILE, oracle->vp.size(), oracle->l1.size(), oracle->bp.size());
+   if (BP_SIDECAR_FILE && !PERFECT_BRANCH_PRED)
+      printf("BP_SIDECAR_FILE = %s (%s)\n", BP_SIDECAR_FILE, (bp_tables ? "recorded" : "loaded"));
    printf("PIPELINE_FILL_LATENCY = %ld\n", PIPELINE_FILL_LATENCY);
    printf("NUM_LDST_LANES = %ld%s", NUM_LDST_LANES, ((NUM_LDST_LANES > 0) ? "\n" : " (unbounded)\n"));
    printf("NUM_ALU_LANES = %ld%s", NUM_ALU_LANES, ((NUM_ALU_LANES > 0) ? "\n" : " (unbounded)\n"));
+   if (fu_pools)
+      fu_pools->print_config();
+   printf("SKIP_INSTS = %ld\n", SKIP_INSTS);
+   printf("WARMUP_INSTS = %ld\n", WARMUP_INSTS);
+   printf("MAX_INSTS = %ld%s", MAX_INSTS, ((MAX_INSTS > 0) ? "\n" : " (unbounded)\n"));
    //BP.output();
    printf("MEMORY HIERARCHY CONFIGURATION---------------------\n");
    printf("STRIDE Prefetcher = %s\n", PREFETCHER_ENABLE ? "1" : "0");
@@ -504,16 +1005,21 @@ void uarchsim_t::output() {
    printf("\t* performed in the L1$. While buffered, conflicting loads get\n");
    printf("\t* the store's data as they would from the SQ.\n");
    if (FETCH_MODEL_ICACHE) {
-      printf("I$: %ld %s, %ld-way set-assoc., %ldB block size\n",
-   	     SCALED_SIZE(IC_SIZE), SCALED_UNIT(IC_SIZE), IC_ASSOC, IC_BLOCKSIZE);
-   }
-   printf("L1$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency\n",
-   	  SCALED_SIZE(L1_SIZE), SCALED_UNIT(L1_SIZE), L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY);
-   printf("L2$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency\n",
-   	  SCALED_SIZE(L2_SIZE), SCALED_UNIT(L2_SIZE), L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY);
-   printf("L3$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency\n",
-   	  SCALED_SIZE(L3_SIZE), SCALED_UNIT(L3_SIZE), L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY);
+      printf("I$: %ld %s, %ld-way set-assoc., %ldB block size, %s replacement\n",
+   	     SCALED_SIZE(IC_SIZE), SCALED_UNIT(IC_SIZE), IC_ASSOC, IC_BLOCKSIZE, repl_policy_names[IC_REPL]);
+   }
+   printf("L1$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency, %s replacement\n",
+   	  SCALED_SIZE(L1_SIZE), SCALED_UNIT(L1_SIZE), L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY, repl_policy_names[L1_REPL]);
+   printf("L2$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency, %s replacement\n",
+   	  SCALED_SIZE(L2_SIZE), SCALED_UNIT(L2_SIZE), L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY, repl_policy_names[L2_REPL]);
+   printf("L3$: %ld %s, %ld-way set-assoc., %ldB block size, %ld-cycle search latency, %s replacement\n",
+   	  SCALED_SIZE(L3_SIZE), SCALED_UNIT(L3_SIZE), L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, repl_policy_names[L3_REPL]);
    printf("Main Memory: %ld-cycle fixed search time\n", MAIN_MEMORY_LATENCY);
+   if (MAIN_MEMORY_BANDWIDTH)
+      printf("Main Memory bandwidth: %ld bytes/cycle (writebacks included)\n", MAIN_MEMORY_BANDWIDTH);
+   else
+      printf("Main Memory bandwidth: unlimited\n");
+   printf("MSHRs (0: unlimited): I$ %ld, L1$ %ld, L2$ %ld, L3$ %ld\n", IC_MSHRS, L1_MSHRS, L2_MSHRS, L3_MSHRS);
    printf("STORE QUEUE MEASUREMENTS---------------------------\n");
    printf("Number of loads: %ld\n", num_load);
    printf("Number of loads that miss in SQ: %ld (%.2f%%)\n", num_load_sqmiss, 100.0*(double)num_load_sqmiss/(double)num_load);
@@ -524,17 +1030,73 @@ void uarchsim_t::output() {
    }
    printf("L1$:\n"); L1.stats();
    printf("L2$:\n"); L2.stats();
-   printf("L3$:\n"); L3.stats();
+   if (llc) {
+      printf("L3$ (shared, this core's view):\n"); llc->stats();
+   }
+   else {
+      printf("L3$:\n"); L3.stats();
+   }
    BP.output();
    printf("ILP LIMIT STUDY------------------------------------\n");
-   printf("instructions = %ld\n", num_inst);
-   printf("cycles       = %ld\n", cycle);
-   printf("IPC          = %.3f\n", ((double)num_inst/(double)cycle));
+   printf("instructions = %ld%s\n", (num_inst - stats_inst_base), (converged() ? " (TRUNCATED: converged)" : ""));
+   printf("cycles       = %ld\n", (cycle - stats_cycle_base));
+   printf("IPC          = %.3f\n", ((double)(num_inst - stats_inst_base)/(double)(cycle - stats_cycle_base)));
+   printf("CPI STACK------------------------------------------\n");
+   printf("Constraint                     cycles       %%     CPI\n");
+   for (int i = 0; i < CPI_NUM_REASONS; i++) {
+      int64_t c = (int64_t)cpi_stack[i];	// can be negative after a reset (see charge_cycle())
+      printf("%-22s %14ld %6.2f%% %7.3f\n", cpi_reason_names[i], c,
+             100.0*((double)c/(double)(cycle - stats_cycle_base)),
+             ((double)c/(double)(num_inst - stats_inst_base)));
+   }
+   if (fu_pools)
+      fu_pools->output();
+   if (convergence) {
+      printf("EARLY TERMINATION----------------------------------\n");
+      printf("truncated    = %s\n", (converged() ? "yes (converged)" : "no"));
+      printf("instructions = %lu measured, %lu simulated\n", (num_inst - stats_inst_base), num_inst);
+      convergence->output();
+   }
    printf("Prefetcher------------------------------------------\n");
    prefetcher.print_stats();
    printf("CVP STUDY------------------------------------------\n");
    printf("prediction-eligible instructions = %ld\n", num_eligible);
    printf("correct predictions              = %ld (%.2f%%)\n", num_correct, (100.0*(double)num_correct/(double)num_eligible));
    printf("incorrect predictions            = %ld (%.2f%%)\n", num_incorrect, (100.0*(double)num_incorrect/(double)num_eligible));
- 
+   printf("MEMORY FOOTPRINT-----------------------------------\n");
+   footprint(true);
+}
+
+#define FOOTPRINT(name, bytes, note) { \
+   uint64_t b = (bytes); \
+   total += b; \
+   if (print) printf("%-20s %10.2f MB%s\n", (name), ((double)b/(double)MEGABYTE), (note)); \
+}
+
+uint64_t uarchsim_t::footprint(bool print) const {
+   uint64_t total = 0;
+   char note[64];
+
+   FOOTPRINT("I$", IC.footprint(), "");
+   FOOTPRINT("L1$", L1.footprint(), "");
+   FOOTPRINT("L2$", L2.footprint(), "");
+   FOOTPRINT("L3$", L3.footprint(), (llc ? " (unused: the L3$ is shared)" : ""));
+   snprintf(note, sizeof(note), " (limit %lu entries, peak %lu)", sq_prune_at, MAX(sq_peak, (uint64_t)SQ.size()));
+   FOOTPRINT("Store queue", (sq_prune_at * SQ_NODE_BYTES), note);
+   FOOTPRINT("Window", (window.footprint() + (WINDOW_SIZE * sizeof(RetireInfo))), "");
+   FOOTPRINT("Execution lanes", ((ldst_lanes ? ldst_lanes->footprint() : 0) + (alu_lanes ? alu_lanes->footprint() : 0) + (fu_pools ? fu_pools->footprint() : 0)), "");
+   FOOTPRINT("Stride prefetcher", prefetcher.footprint(), "");
+   FOOTPRINT("TAGE-SC-L", BP.tage_footprint(), "");
+   FOOTPRINT("ITTAGE and RAS", BP.ittage_footprint(), "");
+   if (VP_ENABLE && !VP_PERFECT) {
+      uint64_t vp = predictorFootprint();
+      FOOTPRINT("Value predictor", vp, (vp ? "" : " (unknown: predictorFootprint() not defined)"));
+   }
+   FOOTPRINT("Trace reader", CVPTraceReader::footprint(), " (estimate)");
+   if (pipeview)
+      FOOTPRINT("Pipeline view", (PIPEVIEW_RING_SIZE * sizeof(pipeview_record_t)), "");
+
+   if (print)
+      printf("%-20s %10.2f MB\n", "Total", ((double)total/(double)MEGABYTE));
+   return(total);
 }
@@ -27,6 +27,13 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "spdlog/fmt/ostr.h"
 #include "cvp.h"
 #include "stride_prefetcher.h"
+#include "interval_stats.h"
+#include "pipeview.h"
+#include "live_stats.h"
+#include "oracle.h"
+#include "fu_pool.h"
+#include "timestamp.h"
+#include "multicore.h"
 using namespace std;
 
 #ifndef _RISCV_UARCHSIM_H
@@ -35,52 +42,125 @@ using namespace std;
 #define RFSIZE 65	// integer: r0-r31.  fp/simd: r32-r63. flags: r64.
 #define RFFLAGS 64	// flags register is r64 (65th register)
 
+// Constraints that can set an instruction's fetch or execution cycle (CPI stack categories).
+enum cpi_reason_t {
+   CPI_BASE = 0,	// pipeline fill between fetch and issue
+   CPI_FETCH_BW,	// fetch bundle constraints: width, branches per cycle, stop at taken/indirect
+   CPI_ICACHE,		// instruction cache miss
+   CPI_EXEC,		// execution latency (for loads: AGEN and L1 hit)
+   CPI_VP_SQUASH,	// value misprediction squash
+   CPI_BRANCH,		// branch misprediction
+   CPI_WINDOW,		// window full
+   CPI_LANE,		// execution lane contention
+   CPI_L1,		// load latency, block supplied by L1$
+   CPI_L2,		// load latency, block supplied by L2$
+   CPI_L3,		// load latency, block supplied by L3$
+   CPI_MEM,		// load latency, block supplied by main memory
+   CPI_SQ,		// load latency, store-load forwarding from the SQ
+   CPI_NUM_REASONS
+};
+
+// Critical-path breakdown of a cycle: the cycles of each CPI stack category along the chain
+// of constraints that set it (fetch stalls, then pipeline fill, execution, lane and load
+// latencies of the producers it depends on), from the start of simulation. The components
+// sum to the cycle. They are 32-bit to keep window entries small and wrap on long runs, so
+// paths are only compared by their differences, which stay small: paths share their history
+// up to a recent divergence.
+struct cpi_path_t {
+   uint32_t c[CPI_NUM_REASONS];
+};
+
+// Measurements of a simulated region (since the last reset_stats()), for combining
+// the results of regions simulated separately.
+struct uarchsim_stats_t {
+   uint64_t num_inst;
+   uint64_t cycle;
+   uint64_t cpi_stack[CPI_NUM_REASONS];
+   uint64_t num_eligible;
+   uint64_t num_correct;
+   uint64_t num_incorrect;
+   uint64_t num_load;
+   uint64_t num_load_sqmiss;
+   uint64_t pfs_issued_to_mem;
+   uint64_t sq_peak;	// largest SQ, in entries (merged: the largest of any region)
+   cache_stats_t ic, l1, l2, l3;
+   bp_stats_t bp;
+   PrefetcherStats pf;
+   fu_pool_stats_t fu[FU_MAX_POOLS];
+};
+
+// Cycle timestamps below are relative to the simulator's epoch (see timestamp.h).
+
 struct window_t {
-   uint64_t retire_cycle;
+   stamp_t retire_cycle;
+   uint32_t latency;
    uint64_t seq_no;
    uint64_t addr;
    uint64_t value;
-   uint64_t latency;
+   cpi_path_t retire_path;	// critical path of retire_cycle (CPI stack)
 };
 
 struct store_queue_t {
-   uint64_t exec_cycle;	// store's execution cycle
-   uint64_t ret_cycle;	// store's commit cycle
+   stamp_t exec_cycle;	// store's execution cycle
+   stamp_t ret_cycle;	// store's commit cycle
 };
 
+// A store queue entry whose store committed by the current fetch cycle can no longer forward to
+// any load. Such entries are pruned whenever the SQ reaches a limit, which is then set to twice
+// the remaining entries (at least SQ_PRUNE_MIN), so the SQ stays proportional to in-flight stores.
+#define SQ_PRUNE_MIN	(1 << 16)	// entries
+#define SQ_NODE_BYTES	(sizeof(std::pair<const uint64_t, store_queue_t>) + 32)	// entry plus red-black tree links
+
 // Class for a microarchitectural simulator.
 
 class uarchsim_t {
    private:
       // Add your class member variables here to facilitate your limit study.
 
-      // register timestamps
-      uint64_t RF[RFSIZE];
+      // epoch base of the RF, SQ and window timestamps (the caches keep their own, rebased together)
+      uint64_t epoch;
+      void rebase(uint64_t new_epoch);
+
+      // register timestamps, and their critical paths (CPI stack)
+      stamp_t RF[RFSIZE];
+      cpi_path_t RF_path[RFSIZE];
 
       // store queue byte timestamps
       map<uint64_t, store_queue_t> SQ;
+      uint64_t sq_prune_at;	// prune the SQ when it reaches this many entries
+      uint64_t sq_peak;		// largest SQ, in entries
+      void prune_sq();
 
       // memory block timestamps
       cache_t L1;
       cache_t L2;
       cache_t L3;
+      shared_cache_port_t *llc;	// multi-core mode: port to the shared L3, which replaces the private L3 (NULL otherwise)
 
       // fetch timestamp
       uint64_t fetch_cycle;
       uint64_t previous_fetch_cycle = 0;
+      cpi_path_t fetch_path;	// critical path of fetch_cycle (CPI stack)
+      void redirect_fetch(uint64_t until, cpi_reason_t reason);
+      void stall_fetch_on_window(uint64_t until, const cpi_path_t &head);
    
       // Modeling resources: (1) finite fetch bundle, (2) finite window, and (3) finite execution lanes.
       uint64_t num_fetched;
       uint64_t num_fetched_branch;
       fifo_t<window_t> window;
+      RetireInfo *retire_batch;		// micro-ops retiring in the same cycle, for updatePredictorBatch()
       resource_schedule *alu_lanes;
       resource_schedule *ldst_lanes;
+      fu_pools_t *fu_pools;		// functional-unit pools per instruction class (NULL if none)
 
       // Branch predictor.
       bp_t BP;
+      bool bp_tables;		// false: the branch predictors are not instantiated
 
       // Instruction cache.
       cache_t IC;
+      uint64_t last_ic_block;	// I$ block of the previous fetch (if ic_block_valid)
+      bool ic_block_valid;
 
       //Prefetcher
       StridePrefetcher prefetcher;
@@ -88,6 +168,18 @@ class uarchsim_t {
       uint64_t num_inst;
       uint64_t cycle;
 
+      // CPI stack: each advance of "cycle" is charged by the change in its critical path, so
+      // the stack is the critical path of the last cycle (less that of the cycle at the last
+      // reset). A category can shrink when the critical path moves to another chain, hence
+      // the modular arithmetic (see output()).
+      uint64_t cpi_stack[CPI_NUM_REASONS];
+      cpi_path_t cycle_path;	// critical path of "cycle"
+      void charge_cycle(uint64_t until, const cpi_path_t &path);
+
+      // Instruction and cycle counts when measurements were last reset (end of warm-up).
+      uint64_t stats_inst_base;
+      uint64_t stats_cycle_base;
+
       // CVP measurements
       uint64_t num_eligible;
       uint64_t num_correct;
@@ -99,17 +191,85 @@ class uarchsim_t {
 
       uint64_t stat_pfs_issued_to_mem = 0;
 
-      // Helper for oracle hit/miss information
-      uint64_t get_load_exec_cycle(db_t *inst) const;
+      // Interval time-series measurements (NULL if disabled).
+      interval_writer_t *interval_stats;
+      void interval_sample();
+      void get_interval_counters(interval_counters_t &c) const;
+
+      // Confidence-driven early termination (NULL if disabled).
+      convergence_t *convergence;
+
+      // Pipeline view export (NULL if disabled).
+      pipeview_writer_t *pipeview;
+
+      // Per-PC oracle overrides (NULL if none).
+      oracle_t *oracle;
+
+      // Live counters page for monitoring scripts (NULL if disabled).
+      live_stats_t *live_stats;
+      void live_update(live_state_t state);
+
+      // Micro-op number within the current trace instruction.
+      uint8_t piece;
+      uint64_t prev_pc;
+
+      // Helper for oracle hit/miss information: a load's execution (AGEN) cycle, given the
+      // cycle its operands are ready
+      uint64_t get_load_exec_cycle(uint64_t ready_cycle) const;
 
    public:
-      uarchsim_t();
+      // Without "bp_tables", branch outcomes come from a sidecar (see bp_sidecar.h) via step().
+      uarchsim_t(shared_cache_port_t *llc = (shared_cache_port_t *)NULL, bool bp_tables = true);
       ~uarchsim_t();
 
       //void set_funcsim(processor_t *funcsim);
-      void step(db_t *inst);
+      // "br_misp_ahead": the micro-op's mispredict flag when the branch predictor was already
+      // trained on it by the decoupled prediction thread (bp_ahead_t), or NULL to predict here.
+      void step(db_t *inst, const bool *br_misp_ahead = (const bool *)NULL);
+      void reset_stats();	// clear all measurements (simulator, caches, BP, prefetcher), keeping microarchitectural state
+      void close_interval_stats();	// emit the last (partial) interval and close the file
+      void close_pipeview();		// write out the queued pipeline view records and close the file
+      void close_live_stats();		// publish the final counters to the live counters page
       void output();
-      PredictionRequest get_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst);
+
+      // Host memory of the major structures, in bytes (the SQ at its current limit). With "print",
+      // also list them (MEMORY FOOTPRINT section).
+      uint64_t footprint(bool print) const;
+
+      // Export the measurements, or add another region's measurements to this simulator's.
+      void get_stats(uarchsim_stats_t &s) const;
+      void add_stats(const uarchsim_stats_t &s);
+
+      // True once the tracked metrics have converged (early termination): the caller should stop.
+      bool converged() const { return(convergence && convergence->converged()); }
+      bool is_core() const { return(llc != NULL); }	// one core of a multi-core run
+
+      bp_t *get_bp() { return(&BP); }
+      uint64_t get_fetch_cycle() const { return(fetch_cycle); }
+      uint64_t get_stamp_floor() const { return(previous_fetch_cycle); }	// no later cache access precedes this cycle
+      uint64_t get_measured_inst() const { return(num_inst - stats_inst_base); }
+      uint64_t get_measured_cycles() const { return(cycle - stats_cycle_base); }
+
+      // "cycle": the cycle the instruction's operands are ready. For a load on the hit/miss track,
+      // "path" receives the lookups of its block (see cache_t::hit_level()).
+      PredictionRequest get_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst, cache_lookup_t *path);
 };
 
+struct CVPTraceReader;
+class bp_ahead_t;
+class bp_sidecar_t;
+
+// Simulate the next instruction of a trace, applying the warm-up (WARMUP_INSTS) and length
+// (MAX_INSTS) limits, early termination and interim reports; "num_sim" counts the simulated
+// instructions. Branch outcomes come from "ahead" or "sidecar" when given (see bp_ahead.h and
+// bp_sidecar.h). Returns false when done.
+bool simulate_inst(CVPTraceReader *reader, uarchsim_t *sim, uint64_t &num_sim, bp_ahead_t *ahead = NULL, bp_sidecar_t *sidecar = NULL);
+
+// Interim reports: the SIGUSR1 handler only sets a flag. simulate_inst() prints the report so far
+// between instructions, headed by "label" (e.g., the shard) if set; the cores of a multi-core run
+// leave it to the quantum barrier, which reports all of them.
+void request_interim_report(int signum);
+bool take_interim_report_request();	// true (once) if a report was requested
+void set_interim_report_label(const char *label);
+
 #endif
@@ -3,6 +3,7 @@
 
 
 #include "mypredictor.h"
+#include "lib/arena.h"
 #include <iostream>
 int seq_commit;
 
@@ -777,6 +778,14 @@ updatePredictor (uint64_t
 
 }
 
+// Host memory of the predictor (before beginPredictor() allocates the tables).
+uint64_t
+predictorFootprint ()
+{
+  return ((NBWAYSTR * (1 << LOGSTR) * sizeof (strdata)) + (3 * BANKDATA * sizeof (longdata)) +
+	  (PREDSIZE * sizeof (vtentry)) + sizeof (Update));
+}
+
 
 
 
@@ -845,6 +854,10 @@ speculativeUpdate (uint64_t seq_no,	// dynamic micro-instruction # (starts at 0
 void
 beginPredictor (int argc_other, char **argv_other)
 {
+  // Looked up on every instruction: from the simulator's huge-page arena, zeroed like static tables.
+  STR = arena_new<strdata> ((NBWAYSTR * (1 << LOGSTR)), ARENA_HOT);
+  LDATA = arena_new<longdata> ((3 * BANKDATA), ARENA_HOT);
+  Vtage = arena_new<vtentry> (PREDSIZE, ARENA_HOT);
 }
 
 void
@@ -122,7 +122,7 @@ struct strdata
   int u;			// 2 bits
   //67 + LOGSTRIDE + WIDTHCONFIDSTR + TAGWIDTHSTR bits 
 };
-static strdata STR[NBWAYSTR * (1 << LOGSTR)];
+static strdata *STR;		// NBWAYSTR * (1 << LOGSTR) entries, allocated by beginPredictor()
 
 
 static int SafeStride = 0;	// 16 bits
@@ -134,7 +134,7 @@ struct longdata
   uint64_t data;
   uint8_t u;
 };
-static longdata LDATA[3 * BANKDATA];
+static longdata *LDATA;		// 3 * BANKDATA entries, allocated by beginPredictor()
 //  managed as a a skewed associative array
 //each entry is 64-LOGLDATA bits for the data (since the other bits can be deduced from the index) + 2 bits for u
 
@@ -148,7 +148,7 @@ struct vtentry
   //LOGLDATA +4 +WIDTHCONFID +TAGWIDTH bits
 };
 
-static vtentry Vtage[PREDSIZE];
+static vtentry *Vtage;		// PREDSIZE entries, allocated by beginPredictor()
 
 #define  MAXTICK 1024
 static int TICK;		//10 bits // for managing replacement on the VTAGE entries
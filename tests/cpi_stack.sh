@@ -0,0 +1,54 @@
+#!/bin/sh
+#
+# Check that the CPI stack rows sum to the measured cycles, with and without perfect branch
+# prediction (-b) and a perfect D$ (-d), and report how the stack compares with the what-if
+# runs: the cycles -b removes against those charged to branch mispredictions, alone and on
+# top of -d, and the cycles -d removes against those charged to loads waiting on
+# L1$/L2$/L3$/main memory. The comparisons are not checked: the stack charges a constraint
+# everything on its critical path, while a what-if run only removes the cycles no other
+# path hides, so the stack overstates constraints with slack (typically branch
+# mispredictions behind long loads) by a trace-dependent factor.
+#
+# Usage: tests/cpi_stack.sh <cvp binary> <trace>
+
+CVP=$1
+TRACE=$2
+if [ ! -x "$CVP" ] || [ ! -f "$TRACE" ]; then
+   echo "Usage: $0 <cvp binary> <trace>"
+   exit 1
+fi
+
+# Print "cycles branch memory" for a run with the given flags, after checking that the rows sum to the cycles.
+stack() {
+   $CVP "$@" "$TRACE" | awk '
+      /^cycles +=/ { cycles = $3 }
+      /^CPI STACK/ { in_stack = 1; next }
+      in_stack && /^Constraint/ { next }
+      in_stack && /^[A-Z]/ && !/%/ { in_stack = 0 }
+      in_stack {
+         n = $(NF-2); sum += n
+         if ($0 ~ /^Branch mispred/) branch += n
+         if ($0 ~ /^Load: (L1|L2|L3)\$|^Load: main memory/) memory += n
+      }
+      END {
+         if (sum != cycles) { printf("FAIL: CPI stack sums to %d, not %d cycles\n", sum, cycles) > "/dev/stderr"; exit 1 }
+         print cycles, branch, memory
+      }'
+}
+
+# Report the "removed" cycles against the "charged" cycles.
+compare() {
+   awk -v what="$1" -v removed="$2" -v charged="$3" 'BEGIN {
+      printf("%s: %d cycles removed, %d charged", what, removed, charged)
+      if (removed > 0)
+         printf(" (%.2fx)", charged/removed)
+      printf("\n")
+   }'
+}
+
+BASE=$(stack) && B=$(stack -b) && D=$(stack -d) && DB=$(stack -d -b) || exit 1
+echo "PASS: CPI stack sums to the cycles (default, -b, -d, -d -b)"
+set -- $BASE $B $D $DB
+compare "-b" $(($1 - $4)) $2
+compare "-b on -d" $(($7 - ${10})) $8
+compare "-d" $(($1 - $7)) $3
@@ -0,0 +1,88 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+// Check that a cache never has more misses outstanding than MSHRs, when its misses are
+// issued out of cycle order: as a last level (MSHRs held for main memory reads) and as a
+// first level (MSHRs held for fills from a next level without MSHRs).
+//
+// Usage: tests/mshr
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "parameters.h"
+#include "arena.h"
+#include "cache.h"
+
+#define NUM_MISSES	400
+#define MSHRS		2
+
+// Most intervals [start, end) that overlap at any cycle.
+static uint64_t max_overlap(const std::vector<std::pair<uint64_t, uint64_t>> &intervals) {
+   std::vector<std::pair<uint64_t, int>> events;
+   for (auto &i : intervals) {
+      events.push_back({i.first, 1});
+      events.push_back({i.second, -1});
+   }
+   std::sort(events.begin(), events.end());	// an end sorts before a start in the same cycle
+   int64_t level = 0, peak = 0;
+   for (auto &e : events) {
+      level += e.second;
+      peak = std::max(peak, level);
+   }
+   return(peak);
+}
+
+// Issue NUM_MISSES reads of distinct blocks to "c" in a scrambled cycle order. Each miss holds
+// an MSHR of "c" for the "hold" cycles before its block is available.
+static bool check(const char *what, cache_t &c, uint64_t hold) {
+   std::vector<std::pair<uint64_t, uint64_t>> intervals;
+   uint64_t x = 12345;
+   for (uint64_t i = 0; i < NUM_MISSES; i++) {
+      x = ((x * 6364136223846793005ULL) + 1442695040888963407ULL);
+      uint64_t cycle = ((x >> 33) % (NUM_MISSES * 4));
+      uint64_t avail = c.access(cycle, true, (i * 64));
+      intervals.push_back({(avail - hold), avail});
+   }
+   uint64_t peak = max_overlap(intervals);
+   bool ok = (peak <= MSHRS);
+   printf("%s: %s at most %lu misses outstanding with %d MSHRs\n", (ok ? "PASS" : "FAIL"), what, peak, MSHRS);
+   return(ok);
+}
+
+int main() {
+   bool ok = true;
+   uint64_t lru = (uint64_t)ReplPolicies::LRU;
+
+   cache_t last(L1_SIZE, L1_ASSOC, 64, 10, (cache_t *)NULL, lru, MSHRS, ARENA_COLD);
+   ok &= check("last level", last, MAIN_MEMORY_LATENCY);
+
+   cache_t next(L2_SIZE, L2_ASSOC, 64, 10, (cache_t *)NULL, lru, 0, ARENA_COLD);
+   cache_t first(L1_SIZE, L1_ASSOC, 64, 3, &next, lru, MSHRS, ARENA_COLD);
+   ok &= check("first level", first, (10 + MAIN_MEMORY_LATENCY));
+
+   return(ok ? 0 : 1);
+}
@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# Check multi-core simulation (-C) on two traces:
+# (1) the weighted speedup of the two traces, and of two copies of the first, is at
+#     most the number of cores: the cores share the L3$ and main memory, nothing else.
+# (2) one core (-C 1) takes exactly as many cycles as the trace simulated alone, with the
+#     default memory model and with a memory bus limited to 1 B/cycle (-Q 0,0,0,0,1).
+#
+# Usage: tests/multicore.sh <cvp binary> <trace0> <trace1>
+
+CVP=$1
+TRACE0=$2
+TRACE1=$3
+if [ ! -x "$CVP" ] || [ ! -f "$TRACE0" ] || [ ! -f "$TRACE1" ]; then
+   echo "Usage: $0 <cvp binary> <trace0> <trace1>"
+   exit 1
+fi
+
+STATUS=0
+
+# Check that the weighted speedup of a run with the given flags and traces is at most its core count.
+speedup() {
+   $CVP "$@" | awk -v what="$*" '
+      /^cores += / { cores = $3 }
+      /^Weighted speedup/ { ws = $NF }
+      END {
+         ok = ((cores > 0) && (ws <= cores))
+         printf("%s: weighted speedup %s on %d cores: %s\n", (ok ? "PASS" : "FAIL"), ws, cores, what)
+         exit !ok
+      }'
+}
+
+# Check that one core with the given flags takes as many cycles as the trace alone with them.
+alone() {
+   ALONE=`$CVP "$@" "$TRACE0" | awk '/^cycles += / { print $3 }'`
+   $CVP "$@" -C 1,1000 "$TRACE0" | awk -v what="$*" -v alone="$ALONE" '
+      /^Core +instructions/ { table = 1; next }
+      table && ($1 == "0") { cycles = $3 }
+      END {
+         ok = ((alone != "") && (cycles == alone))
+         printf("%s: -C 1 %s cycles, alone %s cycles: %s\n", (ok ? "PASS" : "FAIL"), cycles, alone, what)
+         exit !ok
+      }'
+}
+
+speedup -C 2,1000 "$TRACE0" "$TRACE1" || STATUS=1
+speedup -C 2,1000 "$TRACE0" "$TRACE0" || STATUS=1
+alone || STATUS=1
+alone -Q 0,0,0,0,1 || STATUS=1
+exit $STATUS
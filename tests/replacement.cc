@@ -0,0 +1,83 @@
+/*
+
+Copyright (c) 2019, North Carolina State University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+3. The names “North Carolina State University”, “NCSU” and any trade-name, personal name,
+trademark, trade device, service mark, symbol, image, icon, or any abbreviation, contraction or
+simulation thereof owned by North Carolina State University must not be used to endorse or promote products derived from this software without prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+// Author: Eric Rotenberg (ericro@ncsu.edu)
+
+// Check each replacement policy's choice of victim on short access sequences to one set
+// of a 4-way cache, including hits to the block filled last (the MRU way).
+//
+// Usage: tests/replacement
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "parameters.h"
+#include "arena.h"
+#include "cache.h"
+
+#define WAYS		4
+#define BLOCKSIZE	64
+
+struct replacement_case_t {
+   ReplPolicies repl;
+   const char *sequence;	// blocks read in order, one letter each
+   char block;			// block checked at the end
+   bool resident;		// expected: still in the cache
+};
+
+static const replacement_case_t cases[] = {
+   // True and tree pseudo-LRU: a hit makes the block MRU; the LRU block is replaced.
+   {ReplPolicies::LRU,   "AABCDE", 'A', false},
+   {ReplPolicies::LRU,   "ABACDE", 'A', true},
+   {ReplPolicies::PLRU,  "AABCDE", 'A', false},
+   {ReplPolicies::PLRU,  "ABACDE", 'A', true},
+   // RRIP: a hit predicts a near re-reference, whether or not the block was filled last.
+   {ReplPolicies::SRRIP, "AABCDE", 'A', true},
+   {ReplPolicies::SRRIP, "ABACDE", 'A', true},
+   {ReplPolicies::SRRIP, "ABCDE",  'A', false},
+   {ReplPolicies::BRRIP, "AABCDE", 'A', true},
+   {ReplPolicies::BRRIP, "ABACDE", 'A', true},
+   {ReplPolicies::BRRIP, "ABCDE",  'A', false},
+};
+
+// Run "c" on a one-set cache. Accesses are far enough apart for every fill to complete.
+static bool check(const replacement_case_t &c) {
+   cache_t cache((WAYS * BLOCKSIZE), WAYS, BLOCKSIZE, 1, (cache_t *)NULL, (uint64_t)c.repl, 0, ARENA_COLD);
+   uint64_t cycle = 0;
+   for (const char *p = c.sequence; *p; p++) {
+      cycle += 1000;
+      cache.access(cycle, true, ((uint64_t)(*p - 'A') * BLOCKSIZE));
+   }
+   cycle += 1000;
+   bool resident = cache.is_hit(cycle, ((uint64_t)(c.block - 'A') * BLOCKSIZE));
+   bool ok = (resident == c.resident);
+   printf("%s: %s %s leaves %c %s\n", (ok ? "PASS" : "FAIL"), repl_policy_names[(uint64_t)c.repl],
+          c.sequence, c.block, (resident ? "resident" : "replaced"));
+   return(ok);
+}
+
+int main() {
+   bool ok = true;
+   for (uint64_t i = 0; i < (sizeof(cases)/sizeof(cases[0])); i++)
+      ok &= check(cases[i]);
+   return(ok ? 0 : 1);
+}